@@ -0,0 +1,490 @@
+// Booking benchmark: drives the booking, lookup, pricing, rescheduling and reporting paths of
+// Event and of the sharded store, loyalty point expiry and customer search, with synthetic
+// customers at increasing registration counts.
+//
+// Usage: dd_bench [--min N] [--max N] [--out results.jsonl] [--compare baseline.jsonl] [--threshold PCT]
+//
+// Every scenario prints one line to the console and, with --out, one JSON object per line to the
+// results file. Passing a previous results file to --compare reports the change per scenario and
+// exits with status 1 if any throughput dropped by more than the threshold (default 10%).
+#include "event.h"
+#include "session_arena.h"
+#include "session_log.h"
+#include "shard_store.h"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <sys/resource.h>
+
+struct ScenarioResult {
+    string scenario;
+    long long registrations;
+    long long ops;
+    double seconds;
+    vector<long long> samples; // Per-operation latencies in nanoseconds
+    long long failed;          // Operations that went wrong; left out of ops
+};
+
+// Latencies are sampled at a fixed stride so that memory stays bounded at the largest sizes.
+class LatencyRecorder {
+public:
+    LatencyRecorder(ScenarioResult& result, long long expectedOps)
+        : result(result), stride(max(1LL, expectedOps / 1000000)), counter(0) {
+    }
+
+    template <typename Operation>
+    void measure(Operation operation) {
+        if (counter++ % stride != 0) {
+            operation();
+            return;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        operation();
+        chrono::steady_clock::time_point end = chrono::steady_clock::now();
+        result.samples.push_back(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+    }
+
+private:
+    ScenarioResult& result;
+    long long stride;
+    long long counter;
+};
+
+long long percentile(vector<long long>& samples, double q) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = min(samples.size() - 1, static_cast<size_t>(q * samples.size()));
+    nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+long long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+const int FIRST_DAY = 19358; // 2023-01-01
+const int USER_POOL = 1024;
+const char* PACKAGE_TYPES[] = { "Basic Package", "Classic Package", "Premium Package", "Luxury Package" };
+const double PACKAGE_PRICES[] = { 250.0, 500.0, 1000.0, 2500.0 };
+const int SHARDS = 4;
+// The sharded store takes one booking per date, so its scenarios keep to a calendar of a few
+// years; bookings past it land on taken dates and exercise the rejection path instead.
+const int SHARD_CALENDAR_DAYS = 4 * 365 + 1;
+
+// Customers in the search scenario get one of a few thousand full names, as at a busy desk
+const char* FIRST_NAMES[] = {
+    "James", "John", "Robert", "Michael", "William", "David", "Richard", "Joseph", "Thomas", "Charles",
+    "Mary", "Patricia", "Jennifer", "Linda", "Elizabeth", "Barbara", "Susan", "Jessica", "Sarah", "Karen",
+    "Alice", "Nancy", "Lisa", "Betty", "Margaret", "Sandra", "Ashley", "Kimberly", "Emily", "Donna",
+    "Michelle", "Carol", "Amanda", "Melissa", "Deborah", "Stephanie", "Rebecca", "Laura", "Sharon", "Cynthia",
+    "Kathleen", "Amy", "Shirley", "Angela", "Helen", "Anna", "Brenda", "Nicole"
+};
+const char* LAST_NAMES[] = {
+    "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis", "Rodriguez", "Martinez",
+    "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas", "Taylor", "Moore", "Jackson", "Martin",
+    "Lee", "Perez", "Thompson", "White", "Harris", "Sanchez", "Clark", "Ramirez", "Lewis", "Robinson",
+    "Walker", "Young", "Allen", "King", "Wright", "Scott", "Torres", "Nguyen", "Hill", "Flores",
+    "Green", "Adams", "Nelson", "Baker", "Hall", "Rivera", "Campbell", "Tanner"
+};
+// What staff type: partial and misspelt names and a phone prefix, each close to some customer
+const char* SEARCHES[] = { "jhon", "tann", "smiht", "wiliams", "jnoes", "alcie", "margret", "rodrigeuz", "kimberly", "0110042" };
+const long long SEARCH_CUSTOMERS = 1000000; // Largest index searched
+const long long SEARCH_BUDGET_NS = 1000000; // A search slower than this counts as failed
+
+vector<User> makeCustomers() {
+    vector<User> customers;
+    for (int i = 0; i < USER_POOL; ++i) {
+        ostringstream name, email, contact;
+        name << "Customer " << i;
+        email << "customer" << i << "@example.com";
+        contact << "01" << 10000000 + i;
+        customers.push_back(User(name.str(), email.str(), contact.str(), "", 0, i % 3 != 0));
+        customers.back().loyaltyPoints = (i * 7) % 120;
+    }
+    return customers;
+}
+
+// Run every scenario against an Event holding n registrations.
+vector<ScenarioResult> runSize(long long n) {
+    vector<ScenarioResult> results;
+    Event event;
+    vector<User> customers = makeCustomers();
+    mt19937_64 random(42 + n);
+
+    ScenarioResult book = { "book", n, n, 0.0, vector<long long>() };
+    {
+        LatencyRecorder recorder(book, n);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long long i = 0; i < n; ++i) {
+            User& user = customers[i % USER_POOL];
+            int package = static_cast<int>(random() % 4);
+            user.eventDate = formatDate(FIRST_DAY + static_cast<int>(i));
+            user.packageType = PACKAGE_TYPES[package];
+            user.numGuests = 15 + static_cast<int>(random() % 100);
+            double advertisementPrice = random() % 4 == 0 ? 200.0 : 0.0;
+            recorder.measure([&]() {
+                event.book(user, PACKAGE_PRICES[package], advertisementPrice);
+            });
+        }
+        book.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    results.push_back(book);
+
+    ScenarioResult lookup = { "lookup", n, n, 0.0, vector<long long>() };
+    {
+        LatencyRecorder recorder(lookup, n);
+        long long hits = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long long i = 0; i < n; ++i) {
+            string date = formatDate(FIRST_DAY + static_cast<int>(random() % (2 * n)));
+            recorder.measure([&]() {
+                hits += event.isDateBooked(date);
+            });
+        }
+        lookup.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (hits < 0) {
+            cout << hits; // Keep the lookups observable
+        }
+    }
+    results.push_back(lookup);
+
+    ScenarioResult pricing = { "pricing", n, n, 0.0, vector<long long>() };
+    {
+        LatencyRecorder recorder(pricing, n);
+        double packagePrices[MAX_PACKAGES];
+        double advertisementPrices[MAX_ADVERTISEMENTS];
+        double checksum = 0.0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long long i = 0; i < n; ++i) {
+            const User& user = customers[i % USER_POOL];
+            int count = 1 + static_cast<int>(random() % MAX_PACKAGES);
+            for (int p = 0; p < count; ++p) {
+                packagePrices[p] = PACKAGE_PRICES[random() % 4];
+                advertisementPrices[p] = random() % 4 == 0 ? 200.0 : 0.0;
+            }
+            recorder.measure([&]() {
+                checksum += event.quote(user, packagePrices, count, advertisementPrices, count).amount;
+            });
+        }
+        pricing.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (checksum < 0.0) {
+            cout << checksum;
+        }
+    }
+    results.push_back(pricing);
+
+    // Move a slice of the calendar onto days past the last booking
+    long long moves = min(n, 100000LL);
+    ScenarioResult reschedule = { "reschedule", n, moves, 0.0, vector<long long>() };
+    {
+        LatencyRecorder recorder(reschedule, moves);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        User staff; // Nobody is logged in; owners' histories go through the profile store
+        for (long long i = 0; i < moves; ++i) {
+            string oldDate = formatDate(FIRST_DAY + static_cast<int>(i));
+            string newDate = formatDate(FIRST_DAY + static_cast<int>(n + i));
+            recorder.measure([&]() {
+                event.rescheduleDate(staff, oldDate, newDate);
+            });
+        }
+        reschedule.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    results.push_back(reschedule);
+
+    // Reports are rated in registrations per second; a few runs give the latency spread
+    int reportRuns = n <= 100000 ? 5 : 1;
+    ScenarioResult report = { "report", n, n * reportRuns, 0.0, vector<long long>() };
+    {
+        NullBuffer sink;
+        streambuf* console = cout.rdbuf(&sink);
+        LatencyRecorder recorder(report, reportRuns);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int i = 0; i < reportRuns; ++i) {
+            recorder.measure([&]() {
+                event.generateReport();
+            });
+        }
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout.rdbuf(console);
+    }
+    results.push_back(report);
+
+    // The same bookings, moves and reports against worker processes, one per shard of months
+    long long span = min(n, static_cast<long long>(SHARD_CALENDAR_DAYS)); // Dates booked
+    ShardedStore store(SHARDS, static_cast<int>((span + moves) / SHARDS * 2 + 64));
+    if (store.isOpen()) {
+        ScenarioResult shardBook = { "shardbook", n, n, 0.0, vector<long long>() };
+        {
+            LatencyRecorder recorder(shardBook, n);
+            Registration record;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (long long i = 0; i < n; ++i) {
+                const User& user = customers[i % USER_POOL];
+                int package = static_cast<int>(random() % 4);
+                record.userName = user.name;
+                record.email = user.email;
+                record.eventDate = formatDate(FIRST_DAY + static_cast<int>(i % SHARD_CALENDAR_DAYS));
+                record.packageType = PACKAGE_TYPES[package];
+                record.numGuests = 15 + static_cast<int>(random() % 100);
+                record.packagePrice = PACKAGE_PRICES[package];
+                record.advertisementPrice = random() % 4 == 0 ? 200.0 : 0.0;
+                record.isMember = user.isMember;
+                ShardedStore::Status status;
+                recorder.measure([&]() {
+                    status = store.book(record);
+                });
+                ShardedStore::Status expected = i < span ? ShardedStore::SHARD_OK : ShardedStore::SHARD_TAKEN;
+                shardBook.failed += status != expected;
+            }
+            shardBook.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            shardBook.ops -= shardBook.failed;
+        }
+        results.push_back(shardBook);
+
+        // Every booked date moves span days ahead, then back on the next pass
+        ScenarioResult shardMove = { "shardmove", n, moves, 0.0, vector<long long>() };
+        {
+            LatencyRecorder recorder(shardMove, moves);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (long long i = 0; i < moves; ++i) {
+                int day = FIRST_DAY + static_cast<int>(i % span);
+                bool forward = (i / span) % 2 == 0;
+                string oldDate = formatDate(forward ? day : day + static_cast<int>(span));
+                string newDate = formatDate(forward ? day + static_cast<int>(span) : day);
+                ShardedStore::Status status;
+                recorder.measure([&]() {
+                    status = store.reschedule(oldDate, newDate);
+                });
+                shardMove.failed += status != ShardedStore::SHARD_OK;
+            }
+            shardMove.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            shardMove.ops -= shardMove.failed;
+        }
+        results.push_back(shardMove);
+
+        ScenarioResult shardReport = { "shardreport", n, span * reportRuns, 0.0, vector<long long>() };
+        {
+            LatencyRecorder recorder(shardReport, reportRuns);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (int i = 0; i < reportRuns; ++i) {
+                recorder.measure([&]() {
+                    ShardedStore::Report seen = store.report();
+                    shardReport.failed += seen.failedShards > 0 || seen.registrations != span;
+                });
+            }
+            shardReport.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            shardReport.ops -= shardReport.failed * span;
+        }
+        results.push_back(shardReport);
+    }
+    store.stop();
+
+    // Point grants earned over a year, then expired by moving the loyalty clock a day at a time
+    ScenarioResult expire = { "expire", n, 0, 0.0, vector<long long>() };
+    {
+        LoyaltyLedger ledger(FIRST_DAY);
+        vector<string> emails;
+        for (long long i = 0; i < min(n, 100000LL); ++i) {
+            ostringstream email;
+            email << "member" << i << "@example.com";
+            emails.push_back(email.str());
+        }
+        long long perDay = max(1LL, n / LoyaltyLedger::EXPIRY_DAYS);
+        for (long long i = 0; i < n; ++i) {
+            if (i > 0 && i % perDay == 0) {
+                ledger.advance(1);
+            }
+            ledger.earn(emails[i % emails.size()], 10);
+        }
+
+        int days = LoyaltyLedger::EXPIRY_DAYS + 1;
+        LatencyRecorder recorder(expire, days);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int day = 0; day < days; ++day) {
+            recorder.measure([&]() {
+                expire.ops += ledger.advance(1).grants;
+            });
+        }
+        expire.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    results.push_back(expire);
+
+    // Desk searches over a customer index as large as the registrations, up to a million; a search
+    // that finds nobody or runs over its budget counts as failed
+    ScenarioResult search = { "search", n, 10000, 0.0, vector<long long>() };
+    {
+        CustomerIndex index;
+        long long size = min(n, SEARCH_CUSTOMERS);
+        const size_t firstNames = sizeof(FIRST_NAMES) / sizeof(FIRST_NAMES[0]);
+        const size_t lastNames = sizeof(LAST_NAMES) / sizeof(LAST_NAMES[0]);
+        for (long long i = 0; i < size; ++i) {
+            string first = FIRST_NAMES[random() % firstNames];
+            string last = LAST_NAMES[random() % lastNames];
+            ostringstream email, contact;
+            email << first << "." << last << i << "@example.com";
+            contact << "01" << 10000000 + i;
+            index.update(User(first + " " + last, email.str(), contact.str()));
+        }
+
+        SessionArena arena; // Search temporaries come from the session, as at the console
+        const size_t searches = sizeof(SEARCHES) / sizeof(SEARCHES[0]);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (long long i = 0; i < search.ops; ++i) {
+            string query = SEARCHES[i % searches];
+            chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+            bool found = !index.search(query, 20).empty();
+            long long elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count();
+            search.samples.push_back(elapsed);
+            search.failed += !found || elapsed > SEARCH_BUDGET_NS;
+            arena.reset();
+        }
+        search.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        search.ops -= search.failed;
+    }
+    results.push_back(search);
+
+    return results;
+}
+
+string toJson(ScenarioResult& result, long long rssKb) {
+    ostringstream line;
+    line << fixed << setprecision(1)
+        << "{\"scenario\":\"" << result.scenario << "\""
+        << ",\"registrations\":" << result.registrations
+        << ",\"ops\":" << result.ops
+        << ",\"failed\":" << result.failed
+        << ",\"seconds\":" << setprecision(6) << result.seconds
+        << ",\"ops_per_sec\":" << setprecision(1) << (result.seconds > 0.0 ? result.ops / result.seconds : 0.0)
+        << ",\"p50_ns\":" << percentile(result.samples, 0.50)
+        << ",\"p95_ns\":" << percentile(result.samples, 0.95)
+        << ",\"p99_ns\":" << percentile(result.samples, 0.99)
+        << ",\"p999_ns\":" << percentile(result.samples, 0.999)
+        << ",\"max_ns\":" << percentile(result.samples, 1.0)
+        << ",\"peak_rss_kb\":" << rssKb << "}";
+    return line.str();
+}
+
+// Pull a numeric field out of one of our own JSON lines.
+double jsonNumber(const string& line, const string& field) {
+    size_t at = line.find("\"" + field + "\":");
+    if (at == string::npos) {
+        return 0.0;
+    }
+    return atof(line.c_str() + at + field.size() + 3);
+}
+
+string jsonString(const string& line, const string& field) {
+    size_t at = line.find("\"" + field + "\":\"");
+    if (at == string::npos) {
+        return "";
+    }
+    size_t start = at + field.size() + 4;
+    return line.substr(start, line.find('"', start) - start);
+}
+
+string resultKey(const string& line) {
+    ostringstream key;
+    key << jsonString(line, "scenario") << "@" << static_cast<long long>(jsonNumber(line, "registrations"));
+    return key.str();
+}
+
+int main(int argc, char* argv[]) {
+    long long minSize = 1000;
+    long long maxSize = 1000000;
+    string outPath, comparePath;
+    double threshold = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << option << "\n";
+            return 2;
+        }
+        string value = argv[++i];
+        if (option == "--min") {
+            minSize = atoll(value.c_str());
+        }
+        else if (option == "--max") {
+            maxSize = atoll(value.c_str());
+        }
+        else if (option == "--out") {
+            outPath = value;
+        }
+        else if (option == "--compare") {
+            comparePath = value;
+        }
+        else if (option == "--threshold") {
+            threshold = atof(value.c_str());
+        }
+        else {
+            cout << "Unknown option " << option << "\n";
+            return 2;
+        }
+    }
+
+    vector<string> lines;
+    cout << left << setw(12) << "Scenario" << setw(14) << "Registrations" << setw(16) << "Ops/sec"
+        << setw(12) << "p50 (ns)" << setw(12) << "p95 (ns)" << setw(12) << "p99 (ns)" << setw(14) << "Peak RSS (KB)" << "\n";
+    for (long long n = max(1LL, minSize); n <= maxSize; n *= 10) {
+        vector<ScenarioResult> results = runSize(n);
+        long long rssKb = peakRssKb();
+        for (size_t r = 0; r < results.size(); ++r) {
+            string line = toJson(results[r], rssKb);
+            lines.push_back(line);
+            cout << left << setw(12) << results[r].scenario << setw(14) << n
+                << setw(16) << fixed << setprecision(0) << jsonNumber(line, "ops_per_sec")
+                << setw(12) << jsonNumber(line, "p50_ns") << setw(12) << jsonNumber(line, "p95_ns")
+                << setw(12) << jsonNumber(line, "p99_ns") << setw(14) << rssKb << "\n";
+            if (results[r].failed > 0) {
+                cout << "  " << results[r].failed << " " << results[r].scenario << " operations failed\n";
+            }
+        }
+    }
+
+    if (!outPath.empty()) {
+        ofstream out(outPath.c_str());
+        for (size_t i = 0; i < lines.size(); ++i) {
+            out << lines[i] << "\n";
+        }
+    }
+
+    if (comparePath.empty()) {
+        return 0;
+    }
+
+    ifstream baselineFile(comparePath.c_str());
+    if (!baselineFile) {
+        cout << "Cannot open baseline " << comparePath << "\n";
+        return 2;
+    }
+    map<string, string> baseline;
+    string line;
+    while (getline(baselineFile, line)) {
+        if (!line.empty()) {
+            baseline[resultKey(line)] = line;
+        }
+    }
+
+    int regressions = 0;
+    cout << "\nComparison with " << comparePath << " (threshold " << threshold << "%):\n";
+    for (size_t i = 0; i < lines.size(); ++i) {
+        map<string, string>::const_iterator old = baseline.find(resultKey(lines[i]));
+        if (old == baseline.end()) {
+            continue;
+        }
+        double before = jsonNumber(old->second, "ops_per_sec");
+        double after = jsonNumber(lines[i], "ops_per_sec");
+        double change = before > 0.0 ? (after - before) / before * 100.0 : 0.0;
+        bool regressed = change < -threshold;
+        regressions += regressed;
+        cout << " - " << left << setw(24) << old->first << showpos << fixed << setprecision(1) << change << "%" << noshowpos
+            << " throughput, p99 " << jsonNumber(old->second, "p99_ns") << " -> " << jsonNumber(lines[i], "p99_ns") << " ns"
+            << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+// Checks that the customer search index forgets a customer's old details on update.
+#include "event.h"
+
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        cerr << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+
+}
+
+int main() {
+    CustomerIndex index;
+    index.update(User("Alice Smith", "c1024@example.com", "0123456789"));
+    index.update(User("Carol White", "c2048@example.com", "0987654321"));
+    check(index.search("alice", 10).size() == 1, "alice is found before the rename");
+    check(index.search("alcie", 10).size() == 1, "a typo of alice is found before the rename");
+    const size_t entries = index.postingEntries();
+
+    index.update(User("Bob Jones", "c1024@example.com", "0123456789"));
+    check(index.size() == 2, "a rename keeps one entry per email");
+    check(index.search("alice", 10).empty(), "the old first name no longer matches");
+    check(index.search("alcie", 10).empty(), "a typo of the old first name no longer matches");
+    check(index.search("smith", 10).empty(), "the old last name no longer matches");
+    check(index.search("jones", 10).size() == 1, "the new name matches");
+    check(index.search("jnoes", 10).size() == 1, "a typo of the new name matches");
+    check(index.search("carol", 10).size() == 1, "other customers are untouched");
+
+    // Renaming back and forth must not grow the trigram postings.
+    for (int i = 0; i < 100; ++i) {
+        index.update(User("Bob Jones", "c1024@example.com", "0123456789"));
+        index.update(User("Alice Smith", "c1024@example.com", "0123456789"));
+    }
+    check(index.postingEntries() == entries, "postings return to their original size");
+    check(index.search("alice", 10).size() == 1, "alice is found after renaming back");
+
+    if (failures == 0) {
+        cout << "customer_index: all checks passed" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
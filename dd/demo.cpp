@@ -1,848 +1,86 @@
-#include <iostream>
-#include <string>
-#include <map>      // For membership levels
-#include <iomanip>  // For output manipulators
-
-using namespace std;
-
-const int MAX_EVENTS = 100;          // Maximum number of events a user can register for
-const int MAX_INTERACTIONS = 100;    // Maximum number of interactions
-const int MAX_PACKAGES = 10;         // Maximum number of packages
-const int MAX_ADVERTISEMENTS = 10;   // Maximum number of advertisements
-
-class Event; // Forward declaration
-
-
-struct EventSchedule {
-    string time;
-    string activity;
-    string responsiblePerson;
-};
-
-class User {
-public:
-    string name;
-    string email;
-    string contact;
-    string eventDate;
-    int numGuests;           // Number of guests the user is bringing
-    string packageType;
-    bool isMember;           // Indicates if the user is a member
-    string pastEvents[MAX_EVENTS];
-    string pastEventPackages[MAX_EVENTS];
-    int pastEventCount;
-    string interactions[MAX_INTERACTIONS];
-    int interactionCount;
-    int loyaltyPoints;
-
-    User(const string& name = "", const string& email = "", const string& contact = "", const string& packageType = "", int numGuests = 0, bool isMember = false)
-        : name(name), email(email), contact(contact), packageType(packageType), numGuests(numGuests), isMember(isMember), loyaltyPoints(0), pastEventCount(0), interactionCount(0) {
-    }
-
-    // Record any event the user has registered for, including the event name and date.
-    void addEvent(const string& eventName, const string& packageType) {
-        if (pastEventCount < MAX_EVENTS) {
-            pastEvents[pastEventCount] = eventName;
-            pastEventPackages[pastEventCount] = packageType;
-            pastEventCount++;
-        }
-    }
-
-    // Update the event date for a specific event
-    void updateEventDate(int eventIndex, const string& newDate) {
-        if (eventIndex >= 0 && eventIndex < pastEventCount) {
-            pastEvents[eventIndex] = "Event on " + newDate;
-        }
-    }
-
-    // Record the interaction of the user registering for an event.
-    void addInteraction(const string& interaction) {
-        if (interactionCount < MAX_INTERACTIONS) {
-            interactions[interactionCount++] = interaction;
-        }
-    }
-
-    void displayProfile() const {
-        cout << "\n-------- Customer Profile --------\n";
-        cout << "Name: " << name << "\n";
-        cout << "Email: " << email << "\n";
-        cout << "Loyalty Points: " << loyaltyPoints << "\n";
-        cout << "Past Events:\n";
-        for (int i = 0; i < pastEventCount; ++i) {
-            cout << " - " << pastEvents[i] << " (" << pastEventPackages[i] << ")\n";
-        }
-        cout << "----------------------------------\n";
-    }
-};
-
-
-
-
-class Event {
-private:
-    int maxGuests;                      // Total maximum guests allowed for the event
-    map<string, double> membershipDiscounts;
-    map<string, string> packageThemes;
-    map<string, bool> bookedDates; // Map to store booked dates
-
-    // Add these data members for report generation
-    static const int MAX_REGISTRATIONS = 100;
-    struct Registration {
-        string userName;
-        string eventDate;
-        string packageType;
-        int numGuests;
-        double packagePrice;
-        double advertisementPrice;
-        bool isMember;
-    };
-    Registration registrations[MAX_REGISTRATIONS];
-    int registrationCount;
-
-
-public:
-    Event(int maxGuests = 500);
-
-    void registration(User& user, double packagePrices[], int& packageCount, double advertisementPrices[], int& advertisementCount);
-
-    void sendConfirmation(const User& user) {
-        cout << "\nSending confirmation to " << user.email << "...\n";
-        cout << "----------------------------------------\n";
-        cout << "Dear " << user.name << ",\n";
-        cout << "Thank you for registering for the event!\n";
-        cout << "Your event will be held on " << user.eventDate << "!\n";
-        cout << "We look forward to seeing you there.\n";
-        cout << "----------------------------------------\n";
-    }
-
-
-    double package(User& user);
-
-
-
-    void membership(User& user) {
-        cout << "\n-------- Membership Details --------\n";
-        cout << "Your current loyalty points: " << user.loyaltyPoints << "\n";
-        string level = "Basic";
-        if (user.loyaltyPoints >= 100) {
-            level = "Platinum";
-        }
-        else if (user.loyaltyPoints >= 50) {
-            level = "Gold";
-        }
-        else if (user.loyaltyPoints >= 20) {
-            level = "Silver";
-        }
-        cout << "Your membership level: " << level << "\n";
-        cout << "You are entitled to a discount of " << setprecision(0) << membershipDiscounts[level] * 100 << "% on your total.\n";
-        cout << "------------------------------------\n";
-    }
-
-    double advertisement(const User& user, const string& babyName, const string& time, const string& location);
-
-    void manageDate(User& user) {
-        int eventNumber = 1;
-        const int MAX_BOOKED_EVENTS = 100;
-        string eventDates[MAX_BOOKED_EVENTS]; // Array to store event dates
-        string eventPackages[MAX_BOOKED_EVENTS]; // Array to store event packages
-        int eventCount = 0;
-
-        // Display all booked events with numbers
-        cout << endl;
-        cout << "Booked Events:\n";
-        cout << "------------------------------------------------------\n";
-        cout << "|" << left << setw(5) << "No." << left << setw(23) << "Event Date" << "|" << setw(23) << "Package Name" << "|\n";
-        cout << "------------------------------------------------------\n";
-        for (int i = 0; i < user.pastEventCount; ++i) {
-            cout << "|" << left << setw(5) << eventNumber << left << setw(23) << user.pastEvents[i] << "|" << setw(23) << user.pastEventPackages[i] << "|\n";
-            eventDates[eventCount] = user.pastEvents[i];
-            eventPackages[eventCount] = user.pastEventPackages[i];
-            eventCount++;
-            eventNumber++;
-        }
-        cout << "-------------------------------------------------------\n";
-
-        // Check if there are no booked events
-        if (eventCount == 0) {
-            cout << "No events are currently booked.\n";
-            return;
-        }
-
-        while (true) {
-            // Ask if the staff wants to modify an event
-            cout << "Do you want to modify an event? (Y/N): ";
-            char modifyEvent;
-            cin >> modifyEvent;
-            cin.ignore();
-
-            if (modifyEvent != 'Y' && modifyEvent != 'y') {
-                cout << "No modifications made.\n";
-                break;
-            }
-
-            // Prompt staff to choose an event to modify
-            cout << "Enter the number of the event you want to modify: ";
-            int chosenEvent;
-            cin >> chosenEvent;
-            cin.ignore();
-
-            // Check if the chosen event number is valid
-            if (chosenEvent < 1 || chosenEvent > eventCount) {
-                cout << "Error: Invalid event number.\n";
-                return;
-            }
-
-            string eventDate = eventDates[chosenEvent - 1];
-
-            // Prompt for new date
-            cout << "Enter the new date for the event (e.g., 2023-12-31): ";
-            string newDate;
-            getline(cin, newDate);
-
-            // Check if the new date is already booked
-            if (bookedDates.find(newDate) != bookedDates.end() && bookedDates[newDate]) {
-                cout << "Error: The new date is already booked. Please try again.\n";
-                return;
-            }
-
-            // Update the booking
-            bookedDates[eventDate] = false;
-            bookedDates[newDate] = true;
-            user.updateEventDate(chosenEvent - 1, newDate); // Update the event date
-            cout << "Event date updated successfully to " << newDate << ".\n";
-
-            // Ask if the staff wants to modify another event
-            cout << "Do you want to modify another event? (Y/N): ";
-            char modifyAnotherEvent;
-            cin >> modifyAnotherEvent;
-            cin.ignore();
-
-            if (modifyAnotherEvent != 'Y' && modifyAnotherEvent != 'y') {
-                break;
-            }
-        }
-
-        // Display the latest event details
-        cout << "\nLatest Event Details:\n";
-        cout << "------------------------------------------------------\n";
-        cout << "|" << left << setw(5) << "No." << left << setw(23) << "Event Date" << "|" << setw(23) << "Package Name" << "|\n";
-        cout << "------------------------------------------------------\n";
-        for (int i = 0; i < user.pastEventCount; ++i) {
-            cout << "|" << left << setw(5) << i + 1 << left << setw(23) << user.pastEvents[i] << "|" << setw(23) << user.pastEventPackages[i] << "|\n";
-        }
-        cout << "-------------------------------------------------------\n";
-    }
-
-
-    void Payment(User& currentUser, const double packagePrices[], int packageCount, const double advertisementPrices[], int advertisementCount);
-
-    void generateReport();
-
-};
-
-
-Event::Event(int maxGuests) : maxGuests(maxGuests), registrationCount(0) {
-    membershipDiscounts["Basic"] = 0.0;
-    membershipDiscounts["Silver"] = 0.05;   // 5% discount
-    membershipDiscounts["Gold"] = 0.10;     // 10% discount
-    membershipDiscounts["Platinum"] = 0.15; // 15% discount
-
-    packageThemes["Basic Package"] = "Rainbow Baby Shower";
-    packageThemes["Classic Package"] = "Peace and Love Baby Shower";
-    packageThemes["Premium Package"] = "Fairytale Baby Shower";
-    packageThemes["Luxury Package"] = "The Adventure Begin Baby Shower";
-}
-
-
-
-void Event::registration(User& user, double packagePrices[], int& packageCount, double advertisementPrices[], int& advertisementCount) {
-    cout << "------------------- Event Registration -------------------\n";
-	//use date from user input in login()
-    cout << "Registered Name: " << user.name << "\n";
-    cout << "Registered Email: " << user.email << "\n";
-    cout << "Registered Contact: " << user.contact << "\n";
-    cout << "Enter the event date (e.g., 2023-12-31): ";
-    getline(cin, user.eventDate);
-
-    // Check if the date is already booked
-    if (bookedDates[user.eventDate]) {
-        cout << "Error: The date is already booked. Please choose another date.\n";
-        return;
-    }
-
-    // Book the date
-    bookedDates[user.eventDate] = true;
-
-    // Proceed to package selection
-    double packagePrice = package(user);
-
-    if (packagePrice == 0.0) {
-        cout << "Package selection failed. Returning to main menu.\n";
-        return;
-    }
-
-    // Add the event with the date and package type to the user's past events
-    user.addEvent("Event on " + user.eventDate, user.packageType);
-
-    // Increment loyalty points for each event registration
-    user.loyaltyPoints += 10;
-
-    cout << "\nRegistration successful!\n";
-    sendConfirmation(user);
-    cout << endl;
-
-    // Add package price to the array
-    packagePrices[packageCount++] = packagePrice;
-
-    // Proceed to advertisement
-    double advertisementPrice = 0.0;
-    char advertisementChoice;
-    cout << "Do you want to advertise your event --> RM200? (Y/N): ";
-    cin >> advertisementChoice;
-    cin.ignore();
-
-    if (advertisementChoice == 'Y' || advertisementChoice == 'y') {
-        string babyName, time, location;
-        cout << "Enter baby name: ";
-        getline(cin, babyName);
-        cout << "Enter time: ";
-        getline(cin, time);
-        cout << "Enter location: ";
-        getline(cin, location);
-
-        advertisementPrice = advertisement(user, babyName, time, location);
-    }
-    else if (advertisementChoice == 'N' || advertisementChoice == 'n') {
-        cout << "Advertisement not selected.\n";
-    }
-
-    // Add advertisement price to the array
-    advertisementPrices[advertisementCount++] = advertisementPrice;
-
-    // Store registration data for report
-    if (registrationCount < MAX_REGISTRATIONS) {
-        registrations[registrationCount].userName = user.name;
-        registrations[registrationCount].eventDate = user.eventDate;
-        registrations[registrationCount].packageType = user.packageType;
-        registrations[registrationCount].numGuests = user.numGuests;
-        registrations[registrationCount].packagePrice = packagePrice;
-        registrations[registrationCount].advertisementPrice = advertisementPrice;
-        registrations[registrationCount].isMember = user.isMember;
-        registrationCount++;
-    }
-    else {
-        cout << "Maximum number of registrations reached.\n";
-    }
-
-    // Ask if the user wants to add another event
-    char addAnother;
-    cout << "Do you want to add another event? (Y/N): ";
-    cin >> addAnother;
-    cin.ignore();
-
-    if (addAnother == 'Y' || addAnother == 'y') {
-        registration(user, packagePrices, packageCount, advertisementPrices, advertisementCount);
-    }
-    else if (addAnother == 'N' || addAnother == 'n') {
-        cout << "Proceeding to payment...\n";
-        Payment(user, packagePrices, packageCount, advertisementPrices, advertisementCount);
-    }
-}
-
-
-
-
-
-double Event::package(User& user) {
-    int packageChoice, numGuests, maxPackageGuests;
-    double price = 0.0;
-    string packageType;
-
-    cout << endl;
-    cout << "------------------------------------------------------------------------------------\n";
-    cout << "\t\t\t\tEvent Packages\n";
-    cout << "************************************************************************************\n";
-    cout << "1. Basic Package\n";
-    cout << "*Price\t\t: RM250\n";
-    cout << "*Number of guests: 15 to 30\n";
-    cout << "*Theme\t\t: Rainbow Baby Shower\n";
-    cout << "*Basic Inclusion:\n";
-    cout << " - 2 colors of balloon decorations\n";
-    cout << " - Dessert table with 10-inch single tier of round cake, small cupcakes and cookies\n";
-    cout << " - Provide plastic tableware\n";
-    cout << endl;
-
-    cout << "************************************************************************************\n";
-    cout << "2. Classic Package\n";
-    cout << "*Price\t\t: RM500\n";
-    cout << "*Number of guests\t: 30 to 50\n";
-    cout << "*Theme\t\t: Peace and Love Baby Shower\n";
-    cout << "*Basic Inclusion:\n";
-    cout << " - Theme color garland and polaroid pictures\n";
-    cout << " - Dessert table with 10-inch 2 tier of round cake, small cupcakes, cookies and lollipop\n";
-    cout << " - Free decorations of paper invitations\n";
-    cout << endl;
-
-    cout << "************************************************************************************\n";
-    cout << "3. Premium Package\n";
-    cout << "*Price\t\t: RM1000\n";
-    cout << "*Number of guests: 50 to 100\n";
-    cout << "*Theme\t\t: Fairytale Baby Shower\n";
-    cout << "*Basic Inclusion:\n";
-    cout << " - Elegant balloon arch and personalized backdrop\n";
-    cout << " - Dessert table with 12-inch 3 tier of round cake, small cupcakes, cookies and macaron\n";
-    cout << " - Free materials for customer to DIY keepsake corner\n";
-    cout << endl;
-
-    cout << "************************************************************************************\n";
-    cout << "4. Luxury Package\n";
-    cout << "*Price\t\t: RM2500\n";
-    cout << "*Number of guests: 100 and more\n";
-    cout << "*Theme\t\t: The Adventure Begin Baby Shower\n";
-    cout << "*Basic Inclusion:\n";
-    cout << " - A decorated arch with greenery and compass motifs\n";
-    cout << " - Dessert table with 15-inch 3 tier of round cake, small cupcakes, cookies, macaron and donut\n";
-    cout << " - A photo booth with instant photo prints with customized frames\n";
-    cout << "------------------------------------------------------------------------------------\n";
-    cout << endl;
-
-    do {
-        cout << "\nSelect Package Type:\n";
-        cout << "1. Basic Package (up to 30 guests) - RM250\n";
-        cout << "2. Classic Package (up to 50 guests) - RM500\n";
-        cout << "3. Premium Package (up to 100 guests) - RM1000\n";
-        cout << "4. Luxury Package (100 guests or more) - RM2500\n";
-        cout << "Enter your choice: ";
-        cin >> packageChoice;
-
-        switch (packageChoice) {
-        case 1:
-            maxPackageGuests = 30;
-            packageType = "Basic Package";
-            price = 250;
-            break;
-        case 2:
-            maxPackageGuests = 50;
-            packageType = "Classic Package";
-            price = 500;
-            break;
-        case 3:
-            maxPackageGuests = 100;
-            packageType = "Premium Package";
-            price = 1000;
-            break;
-        case 4:
-            maxPackageGuests = maxGuests; // No upper limit
-            packageType = "Luxury Package";
-            price = 2500;
-            break;
-        default:
-            cout << "Invalid choice. Please choose again.\n";
-            packageChoice = 0; // Reset choice to continue loop
-        }
-    } while (packageChoice < 1 || packageChoice > 4);
-
-    cout << "Enter the number of guests (including yourself): ";
-    cin >> numGuests;
-    cin.ignore(); // Ignore newline character
-
-    if (numGuests > maxPackageGuests) {
-        cout << "Number of guests exceeds the limit for " << packageType << ". Please try again.\n";
-        return 0.0; // Return 0 price if the number of guests exceeds the limit
-    }
-
-    user.packageType = packageType;
-    user.numGuests = numGuests;
-
-    string addonType;
-    char addonChoice;
-    int addonChosen;
-    double addonPrice = 0.0;
-    bool validInput = false;
-
-    while (!validInput) {
-        cout << endl;
-        cout << "Do you want to add on? (Y/N): ";
-        cin >> addonChoice;
-        cin.ignore();
-
-        if (addonChoice == 'Y' || addonChoice == 'y') {
-            validInput = true;
-            cout << "Add on Option: \n";
-            cout << "1. Photographer - RM300\n";
-            cout << "2. Photobooth - RM350\n";
-            cout << "3. Master of Event(MC) - RM450\n";
-            cout << "4. None\n";
-            cout << "Enter your choice (1-4): ";
-            cin >> addonChosen;
-            cin.ignore(); // Ignore newline character
-
-            switch (addonChosen) {
-            case 1:
-                addonType = "Photographer";
-                addonPrice = 300;
-                break;
-            case 2:
-                addonType = "Photobooth";
-                addonPrice = 350;
-                break;
-            case 3:
-                addonType = "Master of Event(MC)";
-                addonPrice = 450;
-                break;
-            case 4:
-                addonType = "";
-                addonPrice = 0;
-                break;
-            default:
-                cout << "Invalid choice. Please choose again.\n";
-                validInput = false;
-            }
-        }
-        else if (addonChoice == 'N' || addonChoice == 'n') {
-            validInput = true;
-            addonType = "";
-            addonPrice = 0;
-        }
-        else {
-            cout << "Invalid input. Please enter 'Y' or 'N'.\n";
-        }
-    }
-
-    price += addonPrice;
-
-    cout << "Package selected: " << packageType << "\n";
-    cout << "Your add on: " << addonType << "\n";
-    cout << "Number of guests: " << numGuests << "\n";
-    cout << "Total price: RM" << fixed << setprecision(2) << price << "\n";
-    cout << "----------------------------------------\n";
-
-    return price;
-}
-
-
-double Event::advertisement(const User& user, const string& babyName, const string& time, const string& location) {
-    // Retrieve the theme based on the package
-    string theme = packageThemes[user.packageType];
-
-    // Use user.eventDate and user.contact
-    string eventDate = user.eventDate;
-    string rsvpContact = user.contact;
-
-    // Display the advertisement
-    cout << endl;
-    cout << "------------------------------------------------------------------------------------\n";
-    cout << "\t\t\t\tEvent Advertisement\n";
-    cout << "------------------------------------------------------------------------------------\n";
-    cout << "You are Invited to the Sweetest Baby Shower of the Year!\n\n";
-    cout << "Join us in celebrating the arrival of Baby " << babyName << "!\n\n";
-    cout << "Date: " << eventDate << endl;
-    cout << "Time: " << time << endl;
-    cout << "Location: " << location << "\n\n";
-    cout << "What is in Store?\n";
-    cout << "Fun baby-themed games\n";
-    cout << "Exciting gift exchanges\n";
-    cout << "Delicious treats and refreshments\n\n";
-    cout << "Theme: \"" << theme << "\"\n";
-
-    cout << "Dress to match the theme and bring your best smiles!\n\n";
-    cout << "RSVP Contact: " << rsvpContact << " for more info.\n\n";
-    cout << "Let's make this day special and unforgettable for " << babyName << "'s parents!\n";
-    cout << "------------------------------------------------------------------------------------\n";
-    cout << endl;
-
-    // Wait for user confirmation
-    int chosen;
-    cout << "Press 1 to continue: ";
-    cin >> chosen;
-
-    while (chosen != 1) {
-        cout << "Invalid input. Please try again.\n";
-        cout << "Press 1 to continue: ";
-        cin >> chosen;
-    }
-
-    return 200.0; // Advertisement price
-}
-
-void Event::Payment(User& currentUser, const double packagePrices[], int packageCount, const double advertisementPrices[], int advertisementCount) {
-    int paymentChoice;
-    double totalPackagePrice = 0.0;
-    double totalAdvertisementPrice = 0.0;
-
-    // Calculate total package and advertisement prices
-    for (int i = 0; i < packageCount; ++i) {
-        if (packagePrices[i] > 0.0) {
-            totalPackagePrice += packagePrices[i];
-        }
-    }
-    for (int i = 0; i < advertisementCount; ++i) {
-        if (advertisementPrices[i] > 0.0) {
-            totalAdvertisementPrice += advertisementPrices[i];
-        }
-    }
-
-    double amount = totalPackagePrice + totalAdvertisementPrice;
-    string couponCode;
-    bool validCoupon = false;
-    double discount = 0.0;
-
-    // Display event details in a table format
-    cout << endl;
-    cout << "Event Details:\n";
-    cout << "-------------------------------------------------------------------------\n";
-    cout << "|" << left << setw(23) << "Event Date" << "|" << setw(23) << "Package Name" << "|" << setw(23) << "Package Price" << "|" << "\n";
-    cout << "-------------------------------------------------------------------------\n";
-    for (int i = 0; i < currentUser.pastEventCount; ++i) {
-        if (packagePrices[i] > 0.0) {
-            cout << "|" << left << setw(23) << currentUser.pastEvents[i] << "|" << setw(23) << currentUser.pastEventPackages[i] << "|" << setw(23) << fixed << setprecision(2) << packagePrices[i] << "|" << "\n";
-            cout << "-------------------------------------------------------------------------\n";
-        }
-    }
-
-    // Display membership status and discount rate
-    string level = "Basic";
-    if (currentUser.loyaltyPoints >= 100) {
-        level = "Platinum";
-    }
-    else if (currentUser.loyaltyPoints >= 50) {
-        level = "Gold";
-    }
-    else if (currentUser.loyaltyPoints >= 20) {
-        level = "Silver";
-    }
-    double membershipDiscount = membershipDiscounts[level];
-    cout << endl;
-    cout << "----------------------------------------\n";
-    cout << "|" << "Membership Status\t: " << (currentUser.isMember ? "Member" : "Non-Member") << "\t|\n";
-    cout << "|" << "Membership Level\t: " << level << "\t\t|\n";
-    cout << "|" << "Discount Rate\t\t: " << membershipDiscount * 100 << "%" << "\t|\n";
-    cout << "----------------------------------------\n";
-
-    // Apply membership discount
-    amount = amount * (1 - membershipDiscount);
-
-    cout << endl;
-    cout << "Total amount to pay after membership discount: RM" << fixed << setprecision(2) << amount << "\n";
-
-    cout << "Do you have a discount coupon? (Y/N): ";
-    char couponResponse;
-    cin >> couponResponse;
-    cin.ignore();
-    if (couponResponse == 'Y' || couponResponse == 'y') {
-        cout << "Enter coupon code: ";
-        getline(cin, couponCode);
-        // Validate coupon code (for simplicity, assume "DISCOUNT10" gives a 10% discount)
-        if (couponCode == "DISCOUNT10") {
-            validCoupon = true;
-            discount = 0.10;
-        }
-        else {
-            cout << "Invalid coupon code.\n";
-        }
-    }
-
-    if (validCoupon) {
-        amount = amount * (1 - discount);
-        cout << "Discount applied. New amount to pay: RM" << fixed << setprecision(2) << amount << "\n";
-    }
-
-    string walletID, cardDetails, cvv;
-    int bankChoice;
-    cout << "\nChoose payment method:\n";
-    cout << "1. Credit/Debit Card\n";
-    cout << "2. TNG\n";
-    cout << "3. Bank Transfer(FPX)\n";
-    cout << "\nEnter your choice: ";
-    cin >> paymentChoice;
-    cin.ignore();
-
-    switch (paymentChoice) {
-    case 1:
-        cout << endl;
-        cout << "You have selected Credit/Debit Card.\n";
-        cout << "Enter your card number: ";
-        getline(cin, cardDetails);
-        cout << "Enter CVV: ";
-        getline(cin, cvv);
-        cout << "Processing payment of RM" << fixed << setprecision(2) << amount << " via Credit/Debit Card...\n";
-        cout << "Payment successful! Thank you.\n";
-        break;
-    case 2:
-        cout << endl;
-        cout << "You have selected Touch 'n Go (TNG) Wallet.\n";
-        cout << "Enter your TNG Wallet ID: ";
-        getline(cin, walletID);
-        cout << "Processing payment of RM" << fixed << setprecision(2) << amount << " via TNG Wallet...\n";
-        cout << "Payment successful! Thank you.\n";
-        break;
-    case 3:
-        cout << endl;
-        cout << "You have selected FPX (Online Banking).\n";
-        cout << "Available Banks:\n";
-        cout << "1. Maybank\n";
-        cout << "2. CIMB\n";
-        cout << "3. Public Bank\n";
-        cout << "Enter your bank choice (1-3): ";
-        cin >> bankChoice;
-        cin.ignore();
-        cout << "Redirecting to bank choice " << bankChoice << " online banking portal...\n";
-        cout << "Confirming payment of RM" << fixed << setprecision(2) << amount << "...\n";
-        cout << "Payment successful! Thank you.\n";
-        break;
-    default:
-        cout << "Invalid payment method. Please try again.\n";
-        return;
-    }
-
-    cout << endl;
-    cout << "Press 1 to generate your invoice: ";
-    int invoiceChoice;
-    double subtotal = totalPackagePrice + totalAdvertisementPrice;
-    cin >> invoiceChoice;
-    while (invoiceChoice != 1) {
-        cout << "Invalid input. Please try again.\n";
-        cout << "Press 1 to generate your invoice: ";
-        cin >> invoiceChoice;
-    }
-
-    // Generate and display invoice
-    cout << "\nGenerating invoice...\n";
-    cout << "----------------------------------------\n";
-    cout << "Invoice\n";
-    cout << "----------------------------------------\n";
-    cout << "Name: " << currentUser.name << "\n";
-    cout << "Email: " << currentUser.email << "\n";
-    cout << "----------------------------------------\n";
-    cout << left << setw(30) << "Description" << setw(20) << "Amount (RM)" << "\n";
-    cout << "----------------------------------------\n";
-    cout << left << setw(30) << "Package(s)" << setw(20) << fixed << setprecision(2) << totalPackagePrice << "\n";
-    cout << left << setw(30) << "Advertisement" << setw(20) << fixed << setprecision(2) << totalAdvertisementPrice << "\n";
-    cout << "----------------------------------------\n";
-    cout << left << setw(30) << "Subtotal" << setw(20) << fixed << setprecision(2) << subtotal << "\n";
-    cout << left << setw(30) << "Member Discount" << setw(20) << fixed << setprecision(2) << subtotal * membershipDiscount << "\n";
-    cout << "----------------------------------------\n";
-    cout << left << setw(30) << "Total" << setw(20) << fixed << setprecision(2) << amount << "\n";
-    cout << "----------------------------------------\n";
-    cout << "Invoice sent to " << currentUser.email << "\n";
-
-    int chosen;
-    cout << "Press 1 to continue: ";
-    cin >> chosen;
-
-    while (chosen != 1) {
-        cout << "Invalid input. Please try again.\n";
-        cout << "Press 1 to continue: ";
-        cin >> chosen;
-    }
-}
-
-void Event::generateReport() {
-    cout << "\nGenerating detailed report...\n";
-    cout << "-------------------------------------------------------------------------------------------------------------\n";
-    cout << left << setw(15) << "User Name"
-        << setw(15) << "Event Date"
-        << setw(20) << "Package Type"
-        << setw(10) << "Guests"
-        << setw(15) << "Package Price"
-        << setw(20) << "Advt. Price"
-        << setw(15) << "Member Status" << "\n";
-    cout << "-------------------------------------------------------------------------------------------------------------\n";
-    double totalRevenue = 0.0;
-    int totalGuests = 0;
-    int memberCount = 0;
-    int nonMemberCount = 0;
-    map<string, int> packageSales;
-
-    for (int i = 0; i < registrationCount; ++i) {
-        cout << left << setw(15) << registrations[i].userName
-            << setw(15) << registrations[i].eventDate
-            << setw(20) << registrations[i].packageType
-            << setw(10) << registrations[i].numGuests
-            << setw(15) << fixed << setprecision(2) << registrations[i].packagePrice
-            << setw(20) << registrations[i].advertisementPrice
-            << setw(15) << (registrations[i].isMember ? "Member" : "Non-Member") << "\n";
-
-        totalRevenue += registrations[i].packagePrice + registrations[i].advertisementPrice;
-        totalGuests += registrations[i].numGuests;
-
-        if (registrations[i].isMember) {
-            memberCount++;
-        }
-        else {
-            nonMemberCount++;
-        }
-
-        packageSales[registrations[i].packageType]++;
-    }
-    cout << "-------------------------------------------------------------------------------------------------------------\n";
-    cout << "Total Events: " << registrationCount << "\n";
-    cout << "Total Guests: " << totalGuests << "\n";
-    cout << "Total Revenue: RM" << fixed << setprecision(2) << totalRevenue << "\n";
-    cout << "Members: " << memberCount << " | Non-Members: " << nonMemberCount << "\n";
-    cout << "Package Sales Breakdown:\n";
-    for (const auto& package : packageSales) {
-        cout << " - " << package.first << ": " << package.second << " sales\n";
-    }
-    cout << "-------------------------------------------------------------------------------------------------------------\n";
-}
-
-
-
-
+#include "event.h"
+#include "profile_store.h"
+#include "session_log.h"
 
+#include <fstream>
+#include <thread>
 
-void login(User& user, bool& isStaff) {
-    string userType, username, password;
+void login(User& user, bool& isStaff, Event& event) {
+    InputReader& input = consoleInput();
+    string userType;
+    pmr::string username(sessionMemory()), password(sessionMemory());
 
     cout << "Login as:\n";
     cout << "1. Staff\n";
     cout << "2. Customer\n";
     cout << "Enter your choice: ";
-    cin >> userType;
-    cin.ignore();
+    if (input.readWord(userType) == INPUT_EOF) {
+        return;
+    }
 
     if (userType == "1") {
         isStaff = true;
         // Simulate staff login
         cout << "\nEnter staff username: ";
-        getline(cin, username);
+        input.readLine(username);
         cout << "Enter staff password: ";
-        getline(cin, password);
+        if (input.readLine(password) == INPUT_EOF) {
+            return;
+        }
         cout << "Staff login successful.\n";
     }
     else if (userType == "2") {
         isStaff = false;
+        string name, email, contact;
         cout << "\nEnter your name: ";
-        getline(cin, user.name);
+        input.readLine(name);
         cout << "Enter your email: ";
-        getline(cin, user.email);
+        input.readLine(email);
         cout << "Enter your contact: ";
-        getline(cin, user.contact);
+        if (input.readLine(contact) == INPUT_EOF) {
+            return;
+        }
+
+        // Hand the previous customer's profile back and bring in this customer's history, if any
+        if (customerKey(email) != customerKey(user.email)) {
+            saveProfile(user);
+            if (!loadProfile(email, user)) {
+                user = User();
+            }
+        }
+        user.name = name;
+        user.email = email;
+        user.contact = contact;
+        event.refreshPoints(user);
         cout << "Login successful.\n";
 
         char memberResponse, registerMember;
         cout << "\nAre you a member? (Y/N): ";
-        cin >> memberResponse;
+        if (input.readChar(memberResponse) == INPUT_EOF) {
+            return;
+        }
         user.isMember = (memberResponse == 'Y' || memberResponse == 'y');
-        cin.ignore();
 
 		//if user is memebr then add 10 points
         if (user.isMember) {
-            user.loyaltyPoints += 10; // Add loyalty points for the member
+            event.awardPoints(user, 10); // Add loyalty points for the member
         }
         else {
             cout << "You are not a member. Would you like to sign up for our membership program? (Y/N): ";
-            cin >> registerMember;
-            cin.ignore();
+            if (input.readChar(registerMember) == INPUT_EOF) {
+                return;
+            }
             if (registerMember == 'Y' || registerMember == 'y') {
-                user.loyaltyPoints += 10;
+                event.awardPoints(user, 10);
                 user.isMember = true;
             }
             else {
                 cout << "Thank you for your interest in our membership program!\n";
             }
         }
+
+        // Keep the staff search index up to date with the latest customer details
+        event.indexCustomer(user);
     }
     else {
         cout << "Invalid choice. Please try again.\n";
@@ -851,10 +89,12 @@ void login(User& user, bool& isStaff) {
 }
 
 
-// Main function
-int main() {
+// Run the console from the welcome banner until the user exits or the input ends.
+void runConsole(Event& event) {
+    InputReader& input = consoleInput();
+    SessionArena arena; // Temporaries of each menu action, freed before the next one
     string chosen;
-    
+
         cout << "~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << endl;
         cout << "    ~~~~~~~~~~~~~~~~~~~~~~~~~~~~ WELCOME TO THE ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~" << endl;
         cout << "                 _______      ____    _______     ____     __                   " << endl;
@@ -880,8 +120,9 @@ int main() {
 
         cout << endl;
         cout << "Press 1 to continue or Press 2 to exit: ";
-        cin >> chosen;
-        cin.ignore();
+        if (input.readWord(chosen) == INPUT_EOF) {
+            return;
+        }
 
             
         if (chosen == "1") {
@@ -889,14 +130,15 @@ int main() {
         }
         else if (chosen == "2") {
             cout << "Goodbye!\n";
-            return 0;
+            return;
         }
         else {
             do {
                 cout << "Invalid input. Please try again.\n";
                 cout << "Press 1 to continue or Press 2 to exit: ";
-                cin >> chosen;
-                cin.ignore();
+                if (input.readWord(chosen) == INPUT_EOF) {
+                    return;
+                }
             } while (chosen != "1" && chosen != "2");
         }
 
@@ -908,33 +150,58 @@ int main() {
     //class | object {bring data from login()}, call function
     User user;
     bool isStaff = false;
-    //call the member functions of the Event class
-    Event event;
+
+    // However the session ends, the last customer's profile goes back to the store
+    struct ProfileCheckin {
+        User& user;
+        ~ProfileCheckin() {
+            saveProfile(user);
+        }
+    } checkin = { user };
+
     int choice;
     double packagePrices[MAX_PACKAGES] = { 0 };
+    int packageEvents[MAX_PACKAGES] = { 0 }; // History entry of each charged booking
     double advertisementPrices[MAX_ADVERTISEMENTS] = { 0 };
     int packageCount = 0;
     int advertisementCount = 0;
 
     //When user chooses to exit or back to main menu, the loop will break and the program terminates.
     while (true) {
-        login(user, isStaff);
+        arena.reset();
+        string previousEmail = user.email;
+        login(user, isStaff, event);
+        if (input.eof()) {
+            return; // Input ended
+        }
+        if (!isStaff && customerKey(previousEmail) != customerKey(user.email)) {
+            // Unpaid bookings belong to the customer who made them
+            packageCount = 0;
+            advertisementCount = 0;
+        }
 
         if (isStaff) {
             // Staff menu
             do {
+                arena.reset();
                 cout << endl;
                 cout << "--------------------------------------" << endl;
                 cout << "\t\tStaff Menu\t\t" << endl;
                 cout << "--------------------------------------" << endl;
                 cout << "1. Event Booking on Dates\n"
                     << "2. Event Reporting\n"
-                    << "3. Back to Main Menu\n"
-                    << "4. Exit\n";
+                    << "3. Bulk Reschedule\n"
+                    << "4. Customer Search\n"
+                    << "5. Stage Latency\n"
+                    << "6. Loyalty Clock\n"
+                    << "7. Pricing Rules\n"
+                    << "8. Back to Main Menu\n"
+                    << "9. Exit\n";
                 cout << "--------------------------------------" << endl;
                 cout << "Enter your choice: ";
-                cin >> choice;
-                cin.ignore();
+                if (input.readInt(choice) == INPUT_EOF) {
+                    return;
+                }
 
                 switch (choice) {
                 case 1:
@@ -944,19 +211,57 @@ int main() {
                     event.generateReport();
                     break;
                 case 3:
-                    break; // Break out of the staff menu loop to re-login
+                    event.bulkRescheduleMenu(user);
+                    break;
                 case 4:
+                    event.customerSearch();
+                    break;
+                case 5:
+                    cout << "\nBooking stage latency:\n";
+                    dumpStageLatency(cout);
+                    cout << "\nNotification outbox:\n";
+                    dumpNotificationStats(cout);
+                    cout << "\nProfile cache:\n";
+                    dumpProfileStats(cout);
+                    break;
+                case 6:
+                    event.loyaltyClockMenu();
+                    break;
+                case 7: {
+                    cout << "\nPricing rules:\n";
+                    dumpPricing(cout);
+                    cout << "Reload the pricing file now? (Y/N): ";
+                    char reload;
+                    if (input.readChar(reload) == INPUT_EOF) {
+                        return;
+                    }
+                    if (reload == 'Y' || reload == 'y') {
+                        string error;
+                        if (reloadPricing(error)) {
+                            cout << "Pricing rules reloaded.\n";
+                            dumpPricing(cout);
+                        }
+                        else {
+                            cout << "Error: " << error << ". The previous rules stay in force.\n";
+                        }
+                    }
+                    break;
+                }
+                case 8:
+                    break; // Break out of the staff menu loop to re-login
+                case 9:
                     cout << "Exiting...\n";
-                    return 0;
+                    return;
                 default:
                     cout << "Invalid choice. Please try again.\n";
                 }
 
-            } while (choice != 3);
+            } while (choice != 8);
         }
         else {
             // Customer menu
             do {
+                arena.reset();
                 cout << endl;
                 cout << "--------------------------------------" << endl;
                 cout << "\t\tCustomer Menu\t\t" << endl;
@@ -967,12 +272,13 @@ int main() {
                     << "4. Exit\n";
                 cout << "--------------------------------------" << endl;
                 cout << "Enter your choice: ";
-                cin >> choice;
-                cin.ignore();
+                if (input.readInt(choice) == INPUT_EOF) {
+                    return;
+                }
 
                 switch (choice) {
                 case 1:
-                    event.registration(user, packagePrices, packageCount, advertisementPrices, advertisementCount);
+                    event.registration(user, packagePrices, packageEvents, packageCount, advertisementPrices, advertisementCount);
                     break;
 
                 case 2: {
@@ -985,8 +291,9 @@ int main() {
                             << "3. Back to Customer Menu\n";
                         cout << "--------------------------------------" << endl;
                         cout << "Enter your choice: ";
-                        cin >> crmChoice;
-                        cin.ignore();
+                        if (input.readInt(crmChoice) == INPUT_EOF) {
+                            return;
+                        }
 
                         switch (crmChoice) {
                         case 1:
@@ -1007,7 +314,7 @@ int main() {
                     break; // Break out of the customer menu loop to re-login
                 case 4:
                     cout << "Exiting...\n";
-                    return 0;
+                    return;
                 default:
                     cout << "Invalid choice. Please try again.\n";
                 }
@@ -1015,8 +322,165 @@ int main() {
             } while (choice != 3 && choice != 4);
         }
     }
+}
 
-    return 0;
+// Replay recorded sessions one after another against a fresh Event, with console output
+// discarded, and report throughput and a checksum of the final bookings.
+int replaySessions(const vector<string>& paths, bool paced) {
+    // Whatever decoded is still replayed, but a recording that did not read cleanly fails the run
+    int status = 0;
+    vector<RecordedSession> sessions;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        string error;
+        if (!loadSessions(paths[i], sessions, error)) {
+            cout << "Error: " << error << "\n";
+            status = 1;
+        }
+    }
+
+    Event event;
+    NullBuffer sink;
+    streambuf* console = cout.rdbuf(&sink);
+    size_t lines = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        // At the original pacing, each session starts at the same offset as it did when recorded
+        if (paced) {
+            chrono::milliseconds offset(sessions[i].startMs - sessions[0].startMs);
+            this_thread::sleep_until(start + offset);
+        }
+        ReplaySource replay(sessions[i], paced);
+        InputReader reader(replay);
+        setConsoleInput(&reader);
+        runConsole(event);
+        lines += sessions[i].lines.size();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    setConsoleInput(nullptr);
+    cout.rdbuf(console);
+
+    cout << "Replayed " << sessions.size() << " sessions (" << lines << " input lines) in "
+        << fixed << setprecision(3) << seconds << " s\n";
+    if (seconds > 0.0) {
+        cout << "Throughput: " << setprecision(1) << sessions.size() / seconds << " sessions/s, "
+            << lines / seconds << " lines/s\n";
+    }
+    cout << "Final state checksum: " << hex << setw(16) << setfill('0') << event.stateChecksum() << dec << setfill(' ') << "\n";
+    return status;
 }
 
+// Main function
+//
+// Options:
+//   --record <file>             append this session's input, with timings, to a recording
+//   --replay <file>...          replay recorded sessions instead of reading the keyboard
+//   --paced                     replay at the original pacing rather than as fast as possible
+//   --outbox <dir>              spool directory for confirmation and invoice emails (default: outbox)
+//   --pricing <file>            pricing rules, reloaded when the file changes (default: pricing.cfg)
+//   --profiles <file>           spill file for customer profiles evicted from memory; each run adds its
+//                               process id to the name (default: profiles.cold)
+//   --profile-cache <MB>        memory for customer profiles before they spill to disk (default: 16)
+int main(int argc, char* argv[]) {
+    // Console input goes through InputReader, which flushes cout before it waits for a line,
+    // so the standard streams no longer need to stay in step with C stdio
+    ios::sync_with_stdio(false);
+
+    // Optional stage latency logging: --stage-log <file> [--stage-log-interval <seconds>], --no-stage-timing
+    string stageLogPath;
+    int stageLogInterval = 60;
+    string recordPath;
+    vector<string> replayPaths;
+    bool paced = false;
+    string outboxDir = "outbox";
+    string pricingPath = "pricing.cfg";
+    bool pricingGiven = false;
+    string profilePath = "profiles.cold";
+    size_t profileCacheMb = 16;
+    for (int i = 1; i < argc; ++i) {
+        string option = argv[i];
+        if (option == "--stage-log" && i + 1 < argc) {
+            stageLogPath = argv[++i];
+        }
+        else if (option == "--stage-log-interval" && i + 1 < argc) {
+            stageLogInterval = atoi(argv[++i]);
+        }
+        else if (option == "--no-stage-timing") {
+            setStageTimingEnabled(false);
+        }
+        else if (option == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (option == "--replay") {
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                replayPaths.push_back(argv[++i]);
+            }
+        }
+        else if (option == "--paced") {
+            paced = true;
+        }
+        else if (option == "--outbox" && i + 1 < argc) {
+            outboxDir = argv[++i];
+        }
+        else if (option == "--pricing" && i + 1 < argc) {
+            pricingPath = argv[++i];
+            pricingGiven = true;
+        }
+        else if (option == "--profiles" && i + 1 < argc) {
+            profilePath = argv[++i];
+        }
+        else if (option == "--profile-cache" && i + 1 < argc) {
+            profileCacheMb = static_cast<size_t>(max(atoi(argv[++i]), 0));
+        }
+    }
+    if (!stageLogPath.empty() && !startStageLatencyLog(stageLogPath, stageLogInterval)) {
+        cout << "Warning: cannot write stage latency log to " << stageLogPath << "\n";
+    }
+
+    // Without a pricing file the built-in rules apply; only a file named on the command line must exist
+    string pricingError;
+    bool pricingLoaded = loadPricing(pricingPath, pricingError);
+    if (!pricingLoaded && (pricingGiven || ifstream(pricingPath.c_str()))) {
+        cout << "Warning: " << pricingError << "; using the built-in pricing rules\n";
+    }
+
+    if (!startProfileStore(profilePath, profileCacheMb << 20)) {
+        cout << "Warning: cannot open profile spill file " << profilePath << "; profiles beyond the cache are not kept\n";
+    }
+
+    if (!replayPaths.empty()) {
+        int status = replaySessions(replayPaths, paced);
+        stopProfileStore();
+        stopStageLatencyLog();
+        return status;
+    }
+
+    if (pricingLoaded) {
+        startPricingWatch(pricingPath, 2);
+    }
 
+    // In record mode every input line passes through the recorder on its way to the menus
+    unique_ptr<SessionRecorder> recorder;
+    if (!recordPath.empty()) {
+        recorder.reset(new SessionRecorder(recordPath));
+        if (recorder->isOpen()) {
+            consoleInput().setObserver(recorder.get());
+        }
+        else {
+            cout << "Warning: cannot write session recording to " << recordPath << "\n";
+        }
+    }
+
+    if (!startNotificationOutbox(outboxDir)) {
+        cout << "Warning: cannot open notification outbox in " << outboxDir << "\n";
+    }
+
+    Event event;
+    runConsole(event);
+    stopPricingWatch(); // Before the pricing rules it reloads are torn down
+    stopNotificationOutbox(); // Deliver whatever is still queued
+    stopProfileStore();
+    stopStageLatencyLog(); // Takes its last dump now rather than from a destructor at exit
+
+    consoleInput().setObserver(nullptr);
+    return 0;
+}
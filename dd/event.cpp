@@ -0,0 +1,1074 @@
+#include "event.h"
+#include "profile_store.h"
+
+bool parseDate(const string& date, int& dayNumber) {
+    int y, m, d;
+    char trailing;
+    if (sscanf(date.c_str(), "%d-%2d-%2d%c", &y, &m, &d, &trailing) != 3 || y < 0 || m < 1 || m > 12 || d < 1 || d > 31) {
+        return false;
+    }
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    dayNumber = era * 146097 + dayOfEra - 719468;
+    return true;
+}
+
+string formatDate(int dayNumber) {
+    dayNumber += 719468;
+    int era = (dayNumber >= 0 ? dayNumber : dayNumber - 146096) / 146097;
+    int dayOfEra = dayNumber - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int mp = (5 * dayOfYear + 2) / 153;
+    int d = dayOfYear - (153 * mp + 2) / 5 + 1;
+    int m = mp + (mp < 10 ? 3 : -9);
+    int y = yearOfEra + era * 400 + (m <= 2);
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", y, m, d);
+    return buffer;
+}
+
+int todayDayNumber() {
+    return static_cast<int>(chrono::duration_cast<chrono::hours>(chrono::system_clock::now().time_since_epoch()).count() / 24);
+}
+
+uint64_t hashKey(string_view key) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < key.size(); ++i) {
+        h ^= static_cast<unsigned char>(key[i]);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t notificationId(string_view facts) {
+    char sequence[24];
+    snprintf(sequence, sizeof(sequence), "|%llu", static_cast<unsigned long long>(nextNotificationSequence()));
+    pmr::string key(facts, sessionMemory());
+    key += sequence;
+    return hashKey(key);
+}
+
+namespace {
+
+// "Event on <date>", the name a booking is listed under in the user's past events.
+pmr::string eventListing(const string& date) {
+    pmr::string listing("Event on ", sessionMemory());
+    listing += date;
+    return listing;
+}
+
+void addToTotals(Event::ReportTotals& totals, const Registration& registration) {
+    totals.registrations++;
+    totals.guests += registration.numGuests;
+    totals.members += registration.isMember ? 1 : 0;
+    totals.revenue += registration.packagePrice + registration.advertisementPrice;
+    totals.packageSales[registration.packageType]++;
+}
+
+// Apply `change` to a customer: the console's own copy when they are the one logged in, otherwise
+// their saved profile. A customer with no saved profile has no history to change.
+template <typename Change>
+void changeCustomer(User& current, const string& email, Change change) {
+    if (customerKey(email) == customerKey(current.email)) {
+        change(current);
+        return;
+    }
+    User saved;
+    if (loadProfile(email, saved)) {
+        change(saved);
+        saveProfile(saved);
+    }
+}
+
+}
+
+Event::Event(int maxGuests) : maxGuests(maxGuests), loyalty(todayDayNumber()), waitlistSequence(0) {
+    packageThemes["Basic Package"] = "Rainbow Baby Shower";
+    packageThemes["Classic Package"] = "Peace and Love Baby Shower";
+    packageThemes["Premium Package"] = "Fairytale Baby Shower";
+    packageThemes["Luxury Package"] = "The Adventure Begin Baby Shower";
+}
+
+
+
+void Event::registration(User& user, double packagePrices[], int packageEvents[], int& packageCount, double advertisementPrices[], int& advertisementCount) {
+    InputReader& input = consoleInput();
+    if (packageCount >= MAX_PACKAGES || advertisementCount >= MAX_ADVERTISEMENTS) {
+        cout << "You have reached the maximum of " << MAX_PACKAGES << " events for this session.\n";
+        return;
+    }
+    // Every charge is invoiced against its entry in the customer's history
+    if (user.pastEventCount >= MAX_EVENTS) {
+        cout << "Your booking history is full (" << MAX_EVENTS << " events). Please contact us to book another event.\n";
+        return;
+    }
+
+    cout << "------------------- Event Registration -------------------\n";
+	//use date from user input in login()
+    cout << "Registered Name: " << user.name << "\n";
+    cout << "Registered Email: " << user.email << "\n";
+    cout << "Registered Contact: " << user.contact << "\n";
+    cout << "Enter the event date (e.g., 2023-12-31): ";
+    if (input.readLine(user.eventDate) == INPUT_EOF) {
+        return;
+    }
+
+    // Check if the date is already booked, and book it if not
+    bool alreadyBooked;
+    {
+        DD_TIME_STAGE(STAGE_DATE_CHECK);
+        alreadyBooked = isDateBooked(user.eventDate);
+        if (!alreadyBooked) {
+            bookedDates[user.eventDate] = true;
+        }
+    }
+
+    if (alreadyBooked) {
+        cout << "Error: The date is already booked. Please choose another date.\n";
+
+        char waitChoice;
+        cout << "Would you like to join the waitlist for " << user.eventDate << "? (Y/N): ";
+        if (input.readChar(waitChoice) == INPUT_EOF) {
+            return;
+        }
+        if (waitChoice == 'Y' || waitChoice == 'y') {
+            joinWaitlist(user);
+        }
+        return;
+    }
+
+    // Proceed to package selection
+    double packagePrice = package(user.packageType, user.numGuests);
+
+    if (packagePrice == 0.0) {
+        cout << "Package selection failed. Returning to main menu.\n";
+        return;
+    }
+
+    int historyEntry;
+    {
+        DD_TIME_STAGE(STAGE_ADD_EVENT);
+
+        // Add the event with the date and package type to the user's past events
+        historyEntry = user.addEvent(eventListing(user.eventDate), user.packageType);
+
+        // Increment loyalty points for each event registration
+        awardPoints(user, 10);
+    }
+
+    cout << "\nRegistration successful!\n";
+    sendConfirmation(user);
+    cout << endl;
+
+    // Add package price to the array
+    packageEvents[packageCount] = historyEntry;
+    packagePrices[packageCount++] = packagePrice;
+
+    // Proceed to advertisement
+    double advertisementPrice = 0.0;
+    char advertisementChoice;
+    cout << "Do you want to advertise your event --> " << formatPrice(currentPricing()->advertisementFee) << "? (Y/N): ";
+    if (input.readChar(advertisementChoice) == INPUT_EOF) {
+        return;
+    }
+
+    if (advertisementChoice == 'Y' || advertisementChoice == 'y') {
+        pmr::string babyName(sessionMemory()), time(sessionMemory()), location(sessionMemory());
+        cout << "Enter baby name: ";
+        input.readLine(babyName);
+        cout << "Enter time: ";
+        input.readLine(time);
+        cout << "Enter location: ";
+        if (input.readLine(location) == INPUT_EOF) {
+            return;
+        }
+
+        advertisementPrice = advertisement(user, babyName, time, location);
+    }
+    else if (advertisementChoice == 'N' || advertisementChoice == 'n') {
+        cout << "Advertisement not selected.\n";
+    }
+
+    // Add advertisement price to the array
+    advertisementPrices[advertisementCount++] = advertisementPrice;
+
+    // Store registration data for report
+    Registration record;
+    record.userName = user.name;
+    record.email = user.email;
+    record.eventDate = user.eventDate;
+    record.packageType = user.packageType;
+    record.numGuests = user.numGuests;
+    record.packagePrice = packagePrice;
+    record.advertisementPrice = advertisementPrice;
+    record.isMember = user.isMember;
+    recordRegistration(record);
+
+    // Ask if the user wants to add another event
+    char addAnother;
+    cout << "Do you want to add another event? (Y/N): ";
+    if (input.readChar(addAnother) == INPUT_EOF) {
+        return;
+    }
+
+    if ((addAnother == 'Y' || addAnother == 'y') && packageCount < MAX_PACKAGES && advertisementCount < MAX_ADVERTISEMENTS) {
+        registration(user, packagePrices, packageEvents, packageCount, advertisementPrices, advertisementCount);
+    }
+    else if (addAnother == 'Y' || addAnother == 'y' || addAnother == 'N' || addAnother == 'n') {
+        cout << "Proceeding to payment...\n";
+        Payment(user, packagePrices, packageEvents, packageCount, advertisementPrices, advertisementCount);
+    }
+}
+
+
+
+
+
+bool Event::isDateBooked(const string& date) const {
+    map<string, bool>::const_iterator found = bookedDates.find(date);
+    return found != bookedDates.end() && found->second;
+}
+
+// Book user.eventDate with an already chosen package: the same steps registration() takes, without prompts.
+// Not stage-timed: its steps take a few hundred nanoseconds, so the clock reads would dominate.
+bool Event::book(User& user, double packagePrice, double advertisementPrice) {
+    if (isDateBooked(user.eventDate)) {
+        return false;
+    }
+    bookedDates[user.eventDate] = true;
+    user.addEvent(eventListing(user.eventDate), user.packageType);
+    awardPoints(user, 10);
+
+    Registration record;
+    record.userName = user.name;
+    record.email = user.email;
+    record.eventDate = user.eventDate;
+    record.packageType = user.packageType;
+    record.numGuests = user.numGuests;
+    record.packagePrice = packagePrice;
+    record.advertisementPrice = advertisementPrice;
+    record.isMember = user.isMember;
+    recordRegistration(record);
+    return true;
+}
+
+// Move a booking from oldDate to newDate and offer oldDate to its waitlist.
+bool Event::rescheduleDate(User& current, const string& oldDate, const string& newDate) {
+    if (!isDateBooked(oldDate) || isDateBooked(newDate)) {
+        return false;
+    }
+    bookedDates[newDate] = true;
+    map<string, string> newDates;
+    newDates[oldDate] = newDate;
+    analytics.recordMoves(registrations.rescheduleDates(newDates));
+
+    // The old date is free again; hand it to the next customer waiting for it
+    releaseDate(current, oldDate);
+    return true;
+}
+
+void Event::recordRegistration(const Registration& record) {
+    registrations.append(record);
+    analytics.record(record);
+}
+
+// Queue the customer for user.eventDate with the package they pick now, so the booking can be
+// completed without them if the date is released later. The choice belongs to the waitlist entry,
+// not to the session's own booking.
+void Event::joinWaitlist(User& user) {
+    string packageType;
+    int numGuests = 0;
+    double packagePrice = package(packageType, numGuests);
+    if (packagePrice == 0.0) {
+        cout << "Package selection failed. You have not been added to the waitlist.\n";
+        return;
+    }
+
+    WaitlistEntry entry;
+    entry.tierRank = membershipRank(user.loyaltyPoints);
+    entry.sequence = waitlistSequence++;
+    entry.booking.userName = user.name;
+    entry.booking.email = user.email;
+    entry.booking.eventDate = user.eventDate;
+    entry.booking.packageType = packageType;
+    entry.booking.numGuests = numGuests;
+    entry.booking.packagePrice = packagePrice;
+    entry.booking.advertisementPrice = 0.0;
+    entry.booking.isMember = user.isMember;
+    entry.contact = user.contact;
+
+    Waitlist& waitlist = waitlists[user.eventDate];
+    waitlist.push(entry);
+    user.addInteraction("Joined waitlist for " + user.eventDate);
+    cout << "You have been added to the waitlist for " << user.eventDate << " (" << waitlist.size() << " waiting).\n";
+    cout << "We will book the date for you automatically if it becomes available.\n";
+}
+
+// Free a booked date and promote the highest-priority waiter for it, if any. The promotion is
+// booked like book() does: history entry and points for the waiter, then the confirmation and a
+// payment-due notice, since nobody was at the console to pay for it.
+void Event::releaseDate(User& current, const string& date) {
+    bookedDates[date] = false;
+
+    map<string, Waitlist>::iterator found = waitlists.find(date);
+    if (found == waitlists.end()) {
+        return;
+    }
+
+    WaitlistEntry next = found->second.top();
+    found->second.pop();
+    if (found->second.empty()) {
+        waitlists.erase(found);
+    }
+
+    bookedDates[date] = true;
+    recordRegistration(next.booking);
+
+    const Registration& booking = next.booking;
+    catchUpLoyaltyClock();
+    int points = loyalty.earn(booking.email, 10);
+    changeCustomer(current, booking.email, [&](User& customer) {
+        customer.addEvent(eventListing(date), booking.packageType);
+        customer.loyaltyPoints = points;
+        customer.addInteraction("Promoted from the waitlist for " + date);
+    });
+
+    User promoted(booking.userName, booking.email, next.contact, booking.packageType, booking.numGuests, booking.isMember);
+    promoted.eventDate = date;
+    cout << "Waitlist: " << promoted.name << " has been promoted into the booking on " << date << ".\n";
+    sendConfirmation(promoted);
+
+    Notification due;
+    due.kind = NOTIFY_PAYMENT_DUE;
+    due.email = booking.email;
+    due.name = booking.userName;
+    due.eventDates = date;
+    due.amount = booking.packagePrice + booking.advertisementPrice;
+    char amountText[32];
+    snprintf(amountText, sizeof(amountText), "%.2f", due.amount);
+    pmr::string dueKey("payment-due|", sessionMemory());
+    dueKey.append(due.email).append("|").append(date).append("|").append(amountText);
+    due.id = notificationId(dueKey);
+    queueNotification(due);
+}
+
+double Event::package(string& chosenPackage, int& chosenGuests) {
+    DD_TIME_STAGE(STAGE_PACKAGE);
+    InputReader& input = consoleInput();
+    shared_ptr<const PricingTable> pricing = currentPricing(); // One set of rules for the whole selection
+    int packageChoice, numGuests, maxPackageGuests;
+    double price = 0.0;
+    string packageType;
+
+    // Guest ranges follow the pricing table: each package starts where the previous one ends
+    auto guestRange = [&](int p) {
+        ostringstream range;
+        int limit = pricing->packageGuests[p];
+        int from = p > 0 ? pricing->packageGuests[p - 1] : 0;
+        if (limit > 0 && from > 0) {
+            range << from << " to " << limit;
+        }
+        else if (limit > 0) {
+            range << "up to " << limit;
+        }
+        else if (from > 0) {
+            range << from << " and more";
+        }
+        else {
+            range << "up to the event limit";
+        }
+        return range.str();
+    };
+
+    cout << endl;
+    cout << "------------------------------------------------------------------------------------\n";
+    cout << "\t\t\t\tEvent Packages\n";
+    cout << "************************************************************************************\n";
+    cout << "1. Basic Package\n";
+    cout << "*Price\t\t: " << formatPrice(pricing->packagePrices[0]) << "\n";
+    cout << "*Number of guests: " << guestRange(0) << "\n";
+    cout << "*Theme\t\t: Rainbow Baby Shower\n";
+    cout << "*Basic Inclusion:\n";
+    cout << " - 2 colors of balloon decorations\n";
+    cout << " - Dessert table with 10-inch single tier of round cake, small cupcakes and cookies\n";
+    cout << " - Provide plastic tableware\n";
+    cout << endl;
+
+    cout << "************************************************************************************\n";
+    cout << "2. Classic Package\n";
+    cout << "*Price\t\t: " << formatPrice(pricing->packagePrices[1]) << "\n";
+    cout << "*Number of guests: " << guestRange(1) << "\n";
+    cout << "*Theme\t\t: Peace and Love Baby Shower\n";
+    cout << "*Basic Inclusion:\n";
+    cout << " - Theme color garland and polaroid pictures\n";
+    cout << " - Dessert table with 10-inch 2 tier of round cake, small cupcakes, cookies and lollipop\n";
+    cout << " - Free decorations of paper invitations\n";
+    cout << endl;
+
+    cout << "************************************************************************************\n";
+    cout << "3. Premium Package\n";
+    cout << "*Price\t\t: " << formatPrice(pricing->packagePrices[2]) << "\n";
+    cout << "*Number of guests: " << guestRange(2) << "\n";
+    cout << "*Theme\t\t: Fairytale Baby Shower\n";
+    cout << "*Basic Inclusion:\n";
+    cout << " - Elegant balloon arch and personalized backdrop\n";
+    cout << " - Dessert table with 12-inch 3 tier of round cake, small cupcakes, cookies and macaron\n";
+    cout << " - Free materials for customer to DIY keepsake corner\n";
+    cout << endl;
+
+    cout << "************************************************************************************\n";
+    cout << "4. Luxury Package\n";
+    cout << "*Price\t\t: " << formatPrice(pricing->packagePrices[3]) << "\n";
+    cout << "*Number of guests: " << guestRange(3) << "\n";
+    cout << "*Theme\t\t: The Adventure Begin Baby Shower\n";
+    cout << "*Basic Inclusion:\n";
+    cout << " - A decorated arch with greenery and compass motifs\n";
+    cout << " - Dessert table with 15-inch 3 tier of round cake, small cupcakes, cookies, macaron and donut\n";
+    cout << " - A photo booth with instant photo prints with customized frames\n";
+    cout << "------------------------------------------------------------------------------------\n";
+    cout << endl;
+
+    do {
+        cout << "\nSelect Package Type:\n";
+        for (int p = 0; p < PACKAGE_COUNT; ++p) {
+            int limit = pricing->packageGuests[p];
+            cout << p + 1 << ". " << PACKAGE_NAMES[p];
+            if (limit > 0) {
+                cout << " (up to " << limit << " guests)";
+            }
+            else if (p > 0) {
+                cout << " (" << pricing->packageGuests[p - 1] << " guests or more)";
+            }
+            cout << " - " << formatPrice(pricing->packagePrices[p]) << "\n";
+        }
+        cout << "Enter your choice: ";
+        if (input.readInt(packageChoice) == INPUT_EOF) {
+            return 0.0;
+        }
+
+        if (packageChoice >= 1 && packageChoice <= PACKAGE_COUNT) {
+            int limit = pricing->packageGuests[packageChoice - 1];
+            maxPackageGuests = limit > 0 ? limit : maxGuests; // 0: up to the event limit
+            packageType = PACKAGE_NAMES[packageChoice - 1];
+            price = pricing->packagePrices[packageChoice - 1];
+        }
+        else {
+            cout << "Invalid choice. Please choose again.\n";
+            packageChoice = 0; // Reset choice to continue loop
+        }
+    } while (packageChoice < 1 || packageChoice > PACKAGE_COUNT);
+
+    cout << "Enter the number of guests (including yourself): ";
+    if (input.readInt(numGuests) == INPUT_EOF) {
+        return 0.0;
+    }
+
+    if (numGuests > maxPackageGuests) {
+        cout << "Number of guests exceeds the limit for " << packageType << ". Please try again.\n";
+        return 0.0; // Return 0 price if the number of guests exceeds the limit
+    }
+
+    chosenPackage = packageType;
+    chosenGuests = numGuests;
+
+    string addonType;
+    char addonChoice;
+    int addonChosen;
+    double addonPrice = 0.0;
+    bool validInput = false;
+
+    while (!validInput) {
+        cout << endl;
+        cout << "Do you want to add on? (Y/N): ";
+        if (input.readChar(addonChoice) == INPUT_EOF) {
+            return 0.0;
+        }
+
+        if (addonChoice == 'Y' || addonChoice == 'y') {
+            validInput = true;
+            cout << "Add on Option: \n";
+            for (int a = 0; a < pricing->addonCount; ++a) {
+                cout << a + 1 << ". " << pricing->addonNames[a] << " - " << formatPrice(pricing->addonPrices[a]) << "\n";
+            }
+            int noAddon = pricing->addonCount + 1;
+            cout << noAddon << ". None\n";
+            cout << "Enter your choice (1-" << noAddon << "): ";
+            if (input.readInt(addonChosen) == INPUT_EOF) {
+                return 0.0;
+            }
+
+            if (addonChosen >= 1 && addonChosen < noAddon) {
+                addonType = pricing->addonNames[addonChosen - 1];
+                addonPrice = pricing->addonPrices[addonChosen - 1];
+            }
+            else if (addonChosen == noAddon) {
+                addonType = "";
+                addonPrice = 0;
+            }
+            else {
+                cout << "Invalid choice. Please choose again.\n";
+                validInput = false;
+            }
+        }
+        else if (addonChoice == 'N' || addonChoice == 'n') {
+            validInput = true;
+            addonType = "";
+            addonPrice = 0;
+        }
+        else {
+            cout << "Invalid input. Please enter 'Y' or 'N'.\n";
+        }
+    }
+
+    price += addonPrice;
+
+    cout << "Package selected: " << packageType << "\n";
+    cout << "Your add on: " << addonType << "\n";
+    cout << "Number of guests: " << numGuests << "\n";
+    cout << "Total price: RM" << fixed << setprecision(2) << price << "\n";
+    cout << "----------------------------------------\n";
+
+    return price;
+}
+
+
+double Event::advertisement(const User& user, string_view babyName, string_view time, string_view location) {
+    DD_TIME_STAGE(STAGE_ADVERTISEMENT);
+    InputReader& input = consoleInput();
+    // Retrieve the theme based on the package
+    map<string, string>::const_iterator themed = packageThemes.find(user.packageType);
+    string_view theme = themed != packageThemes.end() ? string_view(themed->second) : string_view();
+
+    // Use user.eventDate and user.contact
+    const string& eventDate = user.eventDate;
+    const string& rsvpContact = user.contact;
+
+    // Display the advertisement
+    cout << endl;
+    cout << "------------------------------------------------------------------------------------\n";
+    cout << "\t\t\t\tEvent Advertisement\n";
+    cout << "------------------------------------------------------------------------------------\n";
+    cout << "You are Invited to the Sweetest Baby Shower of the Year!\n\n";
+    cout << "Join us in celebrating the arrival of Baby " << babyName << "!\n\n";
+    cout << "Date: " << eventDate << endl;
+    cout << "Time: " << time << endl;
+    cout << "Location: " << location << "\n\n";
+    cout << "What is in Store?\n";
+    cout << "Fun baby-themed games\n";
+    cout << "Exciting gift exchanges\n";
+    cout << "Delicious treats and refreshments\n\n";
+    cout << "Theme: \"" << theme << "\"\n";
+
+    cout << "Dress to match the theme and bring your best smiles!\n\n";
+    cout << "RSVP Contact: " << rsvpContact << " for more info.\n\n";
+    cout << "Let's make this day special and unforgettable for " << babyName << "'s parents!\n";
+    cout << "------------------------------------------------------------------------------------\n";
+    cout << endl;
+
+    // Wait for user confirmation
+    int chosen;
+    cout << "Press 1 to continue: ";
+    while (input.readInt(chosen) != INPUT_EOF && chosen != 1) {
+        cout << "Invalid input. Please try again.\n";
+        cout << "Press 1 to continue: ";
+    }
+
+    return currentPricing()->advertisementFee; // Advertisement price
+}
+
+Event::Quote Event::quote(const User& user, const double packagePrices[], int packageCount, const double advertisementPrices[], int advertisementCount) const {
+    Quote result;
+    result.totalPackagePrice = 0.0;
+    result.totalAdvertisementPrice = 0.0;
+
+    // Calculate total package and advertisement prices
+    for (int i = 0; i < packageCount; ++i) {
+        result.totalPackagePrice += max(packagePrices[i], 0.0);
+    }
+    for (int i = 0; i < advertisementCount; ++i) {
+        result.totalAdvertisementPrice += max(advertisementPrices[i], 0.0);
+    }
+
+    // Tier and discount are two lookups in the compiled pricing table
+    shared_ptr<const PricingTable> pricing = currentPricing();
+    int rank = pricing->rank(user.loyaltyPoints);
+    result.level = pricing->tierNames[rank];
+    result.membershipDiscount = pricing->tierDiscounts[rank];
+    result.amount = (result.totalPackagePrice + result.totalAdvertisementPrice) * (1 - result.membershipDiscount);
+    return result;
+}
+
+void Event::Payment(User& currentUser, const double packagePrices[], const int packageEvents[], int packageCount, const double advertisementPrices[], int advertisementCount) {
+    DD_TIME_STAGE(STAGE_PAYMENT);
+    InputReader& input = consoleInput();
+    int paymentChoice;
+    refreshPoints(currentUser); // Points may have expired since login
+    Quote totals = quote(currentUser, packagePrices, packageCount, advertisementPrices, advertisementCount);
+    double totalPackagePrice = totals.totalPackagePrice;
+    double totalAdvertisementPrice = totals.totalAdvertisementPrice;
+    double amount = totals.amount;
+    pmr::string couponCode(sessionMemory());
+    bool validCoupon = false;
+    double discount = 0.0;
+
+    // Display event details in a table format
+    cout << endl;
+    cout << "Event Details:\n";
+    cout << "-------------------------------------------------------------------------\n";
+    cout << "|" << left << setw(23) << "Event Date" << "|" << setw(23) << "Package Name" << "|" << setw(23) << "Package Price" << "|" << "\n";
+    cout << "-------------------------------------------------------------------------\n";
+    for (int i = 0; i < packageCount; ++i) {
+        const int e = packageEvents[i];
+        if (packagePrices[i] > 0.0 && e >= 0 && e < currentUser.pastEventCount) {
+            cout << "|" << left << setw(23) << currentUser.pastEvents[e] << "|" << setw(23) << currentUser.pastEventPackages[e] << "|" << setw(23) << fixed << setprecision(2) << packagePrices[i] << "|" << "\n";
+            cout << "-------------------------------------------------------------------------\n";
+        }
+    }
+
+    // Display membership status and discount rate
+    string level = totals.level;
+    double membershipDiscount = totals.membershipDiscount;
+    cout << endl;
+    cout << "----------------------------------------\n";
+    cout << "|" << "Membership Status\t: " << (currentUser.isMember ? "Member" : "Non-Member") << "\t|\n";
+    cout << "|" << "Membership Level\t: " << level << "\t\t|\n";
+    cout << "|" << "Discount Rate\t\t: " << membershipDiscount * 100 << "%" << "\t|\n";
+    cout << "----------------------------------------\n";
+
+    cout << endl;
+    cout << "Total amount to pay after membership discount: RM" << fixed << setprecision(2) << amount << "\n";
+
+    cout << "Do you have a discount coupon? (Y/N): ";
+    char couponResponse;
+    if (input.readChar(couponResponse) == INPUT_EOF) {
+        return;
+    }
+    if (couponResponse == 'Y' || couponResponse == 'y') {
+        cout << "Enter coupon code: ";
+        if (input.readLine(couponCode) == INPUT_EOF) {
+            return;
+        }
+        // Validate coupon code (for simplicity, assume "DISCOUNT10" gives a 10% discount)
+        if (couponCode == "DISCOUNT10") {
+            validCoupon = true;
+            discount = 0.10;
+        }
+        else {
+            cout << "Invalid coupon code.\n";
+        }
+    }
+
+    if (validCoupon) {
+        amount = amount * (1 - discount);
+        cout << "Discount applied. New amount to pay: RM" << fixed << setprecision(2) << amount << "\n";
+    }
+
+    pmr::string walletID(sessionMemory()), cardDetails(sessionMemory()), cvv(sessionMemory());
+    int bankChoice;
+    cout << "\nChoose payment method:\n";
+    cout << "1. Credit/Debit Card\n";
+    cout << "2. TNG\n";
+    cout << "3. Bank Transfer(FPX)\n";
+    cout << "\nEnter your choice: ";
+    if (input.readInt(paymentChoice) == INPUT_EOF) {
+        return;
+    }
+
+    switch (paymentChoice) {
+    case 1:
+        cout << endl;
+        cout << "You have selected Credit/Debit Card.\n";
+        cout << "Enter your card number: ";
+        input.readLine(cardDetails);
+        cout << "Enter CVV: ";
+        if (input.readLine(cvv) == INPUT_EOF) {
+            return;
+        }
+        cout << "Processing payment of RM" << fixed << setprecision(2) << amount << " via Credit/Debit Card...\n";
+        cout << "Payment successful! Thank you.\n";
+        break;
+    case 2:
+        cout << endl;
+        cout << "You have selected Touch 'n Go (TNG) Wallet.\n";
+        cout << "Enter your TNG Wallet ID: ";
+        if (input.readLine(walletID) == INPUT_EOF) {
+            return;
+        }
+        cout << "Processing payment of RM" << fixed << setprecision(2) << amount << " via TNG Wallet...\n";
+        cout << "Payment successful! Thank you.\n";
+        break;
+    case 3:
+        cout << endl;
+        cout << "You have selected FPX (Online Banking).\n";
+        cout << "Available Banks:\n";
+        cout << "1. Maybank\n";
+        cout << "2. CIMB\n";
+        cout << "3. Public Bank\n";
+        cout << "Enter your bank choice (1-3): ";
+        if (input.readInt(bankChoice) == INPUT_EOF) {
+            return;
+        }
+        cout << "Redirecting to bank choice " << bankChoice << " online banking portal...\n";
+        cout << "Confirming payment of RM" << fixed << setprecision(2) << amount << "...\n";
+        cout << "Payment successful! Thank you.\n";
+        break;
+    default:
+        cout << "Invalid payment method. Please try again.\n";
+        return;
+    }
+
+    cout << endl;
+    cout << "Press 1 to generate your invoice: ";
+    int invoiceChoice;
+    double subtotal = totalPackagePrice + totalAdvertisementPrice;
+    while (input.readInt(invoiceChoice) != INPUT_EOF && invoiceChoice != 1) {
+        cout << "Invalid input. Please try again.\n";
+        cout << "Press 1 to generate your invoice: ";
+    }
+    if (input.eof()) {
+        return;
+    }
+
+    // Generate and display invoice
+    cout << "\nGenerating invoice...\n";
+    cout << "----------------------------------------\n";
+    cout << "Invoice\n";
+    cout << "----------------------------------------\n";
+    cout << "Name: " << currentUser.name << "\n";
+    cout << "Email: " << currentUser.email << "\n";
+    cout << "----------------------------------------\n";
+    cout << left << setw(30) << "Description" << setw(20) << "Amount (RM)" << "\n";
+    cout << "----------------------------------------\n";
+    cout << left << setw(30) << "Package(s)" << setw(20) << fixed << setprecision(2) << totalPackagePrice << "\n";
+    cout << left << setw(30) << "Advertisement" << setw(20) << fixed << setprecision(2) << totalAdvertisementPrice << "\n";
+    cout << "----------------------------------------\n";
+    cout << left << setw(30) << "Subtotal" << setw(20) << fixed << setprecision(2) << subtotal << "\n";
+    cout << left << setw(30) << "Member Discount" << setw(20) << fixed << setprecision(2) << subtotal * membershipDiscount << "\n";
+    cout << "----------------------------------------\n";
+    cout << left << setw(30) << "Total" << setw(20) << fixed << setprecision(2) << amount << "\n";
+    cout << "----------------------------------------\n";
+
+    // The invoice email goes out from the notification outbox, off the payment path
+    Notification invoice;
+    invoice.kind = NOTIFY_INVOICE;
+    invoice.email = currentUser.email;
+    invoice.name = currentUser.name;
+    const string_view prefix = "Event on ";
+    for (int i = 0; i < packageCount; ++i) {
+        const int e = packageEvents[i];
+        if (packagePrices[i] > 0.0 && e >= 0 && e < currentUser.pastEventCount) {
+            string_view date = currentUser.pastEvents[e];
+            if (date.compare(0, prefix.size(), prefix) == 0) {
+                date.remove_prefix(prefix.size());
+            }
+            if (!invoice.eventDates.empty()) {
+                invoice.eventDates += ", ";
+            }
+            invoice.eventDates += date;
+        }
+    }
+    invoice.amount = amount;
+    char amountText[32];
+    snprintf(amountText, sizeof(amountText), "%.2f", amount);
+    pmr::string invoiceKey("invoice|", sessionMemory());
+    invoiceKey.append(invoice.email).append("|").append(invoice.eventDates).append("|").append(amountText);
+    invoice.id = notificationId(invoiceKey);
+    queueNotification(invoice);
+    cout << "Invoice will be emailed to " << currentUser.email << "\n";
+
+    int chosen;
+    cout << "Press 1 to continue: ";
+    while (input.readInt(chosen) != INPUT_EOF && chosen != 1) {
+        cout << "Invalid input. Please try again.\n";
+        cout << "Press 1 to continue: ";
+    }
+}
+
+// Move every booking in the closed range [closedFrom, closedTo] to the earliest free dates in
+// [targetFrom, targetTo]. The whole plan is built before anything is touched, so the moves are
+// applied together; bookings that do not fit in the target window keep their original date.
+Event::RescheduleResult Event::bulkReschedule(User& user, const string& closedFrom, const string& closedTo, const string& targetFrom, const string& targetTo) {
+    RescheduleResult result;
+    result.cancelledWaits = 0;
+    int closedStart, closedEnd, targetStart, targetEnd;
+    if (!parseDate(closedFrom, closedStart) || !parseDate(closedTo, closedEnd) ||
+        !parseDate(targetFrom, targetStart) || !parseDate(targetTo, targetEnd)) {
+        result.error = "Invalid date. Please use the format YYYY-MM-DD.";
+        return result;
+    }
+    if (closedStart > closedEnd) {
+        result.error = "The last closed date is before the first one.";
+        return result;
+    }
+    if (targetStart > targetEnd) {
+        result.error = "The latest new date is before the earliest one.";
+        return result;
+    }
+
+    // Booked dates are kept in a sorted map, so the affected bookings are one range scan away.
+    vector<string> affected;
+    map<string, bool>::const_iterator first = bookedDates.lower_bound(formatDate(closedStart));
+    map<string, bool>::const_iterator last = bookedDates.upper_bound(formatDate(closedEnd));
+    for (map<string, bool>::const_iterator it = first; it != last; ++it) {
+        if (it->second) {
+            affected.push_back(it->first);
+        }
+    }
+
+    // Walk the target window once, handing out free days in date order.
+    int cursor = targetStart;
+    for (size_t i = 0; i < affected.size(); ++i) {
+        string candidate;
+        while (cursor <= targetEnd) {
+            int day = cursor++;
+            if (day >= closedStart && day <= closedEnd) {
+                continue; // Never move a booking into the closure itself
+            }
+            string date = formatDate(day);
+            map<string, bool>::const_iterator booked = bookedDates.find(date);
+            if (booked == bookedDates.end() || !booked->second) {
+                candidate = date;
+                break;
+            }
+        }
+
+        if (candidate.empty()) {
+            result.unplaced.push_back(affected[i]);
+        }
+        else {
+            DateMove move;
+            move.oldDate = affected[i];
+            move.newDate = candidate;
+            result.moved.push_back(move);
+        }
+    }
+
+    // Apply the plan: release every old date first, then book the new ones.
+    map<string, string> newDates;
+    for (size_t i = 0; i < result.moved.size(); ++i) {
+        bookedDates[result.moved[i].oldDate] = false;
+        newDates[result.moved[i].oldDate] = result.moved[i].newDate;
+    }
+    vector<RegistrationStore::MovedBooking> movedBookings = registrations.rescheduleDates(newDates);
+    analytics.recordMoves(movedBookings);
+    for (size_t i = 0; i < result.moved.size(); ++i) {
+        bookedDates[result.moved[i].newDate] = true;
+    }
+    moveHistory(user, movedBookings);
+
+    // Nobody can be promoted into a closed date, so its waitlist goes
+    map<string, Waitlist>::iterator waiting = waitlists.lower_bound(formatDate(closedStart));
+    while (waiting != waitlists.end() && waiting->first <= formatDate(closedEnd)) {
+        const string date = waiting->first;
+        for (Waitlist& queue = waiting->second; !queue.empty(); queue.pop()) {
+            changeCustomer(user, queue.top().booking.email, [&](User& customer) {
+                customer.addInteraction("Waitlist for " + date + " cancelled: the date was closed");
+            });
+            result.cancelledWaits++;
+        }
+        waiting = waitlists.erase(waiting);
+    }
+
+    return result;
+}
+
+void Event::moveHistory(User& current, const vector<RegistrationStore::MovedBooking>& moved) {
+    for (size_t i = 0; i < moved.size(); ++i) {
+        const RegistrationStore::MovedBooking& booking = moved[i];
+        pmr::string listing = eventListing(booking.oldDate);
+        changeCustomer(current, booking.email, [&](User& customer) {
+            for (int e = 0; e < customer.pastEventCount; ++e) {
+                if (customer.pastEvents[e] == string_view(listing)) {
+                    customer.updateEventDate(e, booking.newDate);
+                }
+            }
+        });
+    }
+}
+
+void Event::bulkRescheduleMenu(User& user) {
+    InputReader& input = consoleInput();
+    string closedFrom, closedTo, targetFrom, targetTo;
+
+    cout << "\n-------- Bulk Reschedule --------\n";
+    cout << "Enter the first closed date (e.g., 2023-12-01): ";
+    input.readLine(closedFrom);
+    cout << "Enter the last closed date (e.g., 2023-12-31): ";
+    input.readLine(closedTo);
+    cout << "Enter the earliest new date (e.g., 2024-01-01): ";
+    input.readLine(targetFrom);
+    cout << "Enter the latest new date (e.g., 2024-03-31): ";
+    if (input.readLine(targetTo) == INPUT_EOF) {
+        return;
+    }
+
+    RescheduleResult result = bulkReschedule(user, closedFrom, closedTo, targetFrom, targetTo);
+    if (!result.error.empty()) {
+        cout << "Error: " << result.error << "\n";
+        return;
+    }
+
+    cout << "\nRescheduled Events:\n";
+    cout << "------------------------------------------------------\n";
+    cout << "|" << left << setw(26) << "Old Date" << "|" << setw(25) << "New Date" << "|\n";
+    cout << "------------------------------------------------------\n";
+    for (size_t i = 0; i < result.moved.size(); ++i) {
+        cout << "|" << left << setw(26) << result.moved[i].oldDate << "|" << setw(25) << result.moved[i].newDate << "|\n";
+    }
+    cout << "------------------------------------------------------\n";
+    cout << "Events moved: " << result.moved.size() << "\n";
+
+    if (!result.unplaced.empty()) {
+        cout << "Events that could not be placed (" << result.unplaced.size() << "):\n";
+        for (size_t i = 0; i < result.unplaced.size(); ++i) {
+            cout << " - " << result.unplaced[i] << "\n";
+        }
+    }
+    if (result.cancelledWaits > 0) {
+        cout << "Waitlist entries cancelled for closed dates: " << result.cancelledWaits << "\n";
+    }
+}
+
+void Event::customerSearch() {
+    InputReader& input = consoleInput();
+    cout << "\n-------- Customer Search --------\n";
+    cout << "Enter part of a name, email or contact: ";
+    string query;
+    if (input.readLine(query) == INPUT_EOF) {
+        return;
+    }
+
+    vector<int> matches = customers.search(query, 20);
+    if (matches.empty()) {
+        cout << "No matching customers found.\n";
+        return;
+    }
+
+    cout << "-------------------------------------------------------------------------\n";
+    cout << "|" << left << setw(23) << "Name" << "|" << setw(30) << "Email" << "|" << setw(16) << "Contact" << "|\n";
+    cout << "-------------------------------------------------------------------------\n";
+    for (size_t i = 0; i < matches.size(); ++i) {
+        const CustomerIndex::Customer& customer = customers.customer(matches[i]);
+        cout << "|" << left << setw(23) << customer.name << "|" << setw(30) << customer.email << "|" << setw(16) << customer.contact << "|\n";
+    }
+    cout << "-------------------------------------------------------------------------\n";
+    cout << matches.size() << " of " << customers.size() << " customers matched.\n";
+}
+
+void Event::loyaltyClockMenu() {
+    InputReader& input = consoleInput();
+    catchUpLoyaltyClock();
+
+    cout << "\n-------- Loyalty Clock --------\n";
+    cout << "Today: " << formatDate(loyalty.today()) << "\n";
+    cout << "Active point grants: " << loyalty.activeGrants() << "\n";
+    cout << "Enter the number of days to advance (0 to go back): ";
+    int days;
+    if (input.readInt(days) == INPUT_EOF) {
+        return;
+    }
+    if (days < 0) {
+        cout << "Error: The clock cannot go backwards.\n";
+        return;
+    }
+
+    if (days > 0) {
+        LoyaltyLedger::ExpiryReport report = advanceLoyaltyClock(days);
+        cout << "Clock moved to " << formatDate(loyalty.today()) << ".\n";
+        cout << "Expired " << report.grants << " grants (" << report.points << " points); "
+            << report.tierChanges << " customers changed tier.\n";
+    }
+
+    shared_ptr<const PricingTable> pricing = currentPricing();
+    cout << "Customers by tier:";
+    for (int rank = 0; rank < MEMBERSHIP_TIERS; ++rank) {
+        cout << (rank == 0 ? " " : ", ") << pricing->tierNames[rank] << " " << loyalty.customersInTier(rank);
+    }
+    cout << "\n";
+}
+
+uint64_t Event::stateChecksum() const {
+    uint64_t checksum = 0;
+    for (map<string, bool>::const_iterator it = bookedDates.begin(); it != bookedDates.end(); ++it) {
+        if (it->second) {
+            checksum = (checksum ^ hashKey(it->first)) * 1099511628211ULL;
+        }
+    }
+
+    shared_ptr<const RegistrationStore::Snapshot> view = registrations.snapshot();
+    for (size_t s = 0; s < view->segments.size(); ++s) {
+        const RegistrationStore::Segment& segment = *view->segments[s];
+        for (int i = 0; i < segment.count; ++i) {
+            const Registration& registration = segment.items[i];
+            ostringstream fields;
+            fields << registration.userName << '|' << registration.email << '|' << registration.eventDate << '|'
+                << registration.packageType << '|' << registration.numGuests << '|' << fixed << setprecision(2)
+                << registration.packagePrice << '|' << registration.advertisementPrice << '|' << registration.isMember;
+            checksum = (checksum ^ hashKey(fields.str())) * 1099511628211ULL;
+        }
+    }
+    return checksum;
+}
+
+Event::ReportTotals Event::reportTotals() const {
+    shared_ptr<const RegistrationStore::Snapshot> view = registrations.snapshot();
+    ReportTotals totals = ReportTotals();
+    for (size_t s = 0; s < view->segments.size(); ++s) {
+        const RegistrationStore::Segment& segment = *view->segments[s];
+        for (int i = 0; i < segment.count; ++i) {
+            addToTotals(totals, segment.items[i]);
+        }
+    }
+    return totals;
+}
+
+void Event::generateReport() {
+    // Work from a point-in-time snapshot so bookings can continue while the report runs.
+    shared_ptr<const RegistrationStore::Snapshot> view = registrations.snapshot();
+
+    cout << "\nGenerating detailed report...\n";
+    cout << "-------------------------------------------------------------------------------------------------------------\n";
+    cout << left << setw(15) << "User Name"
+        << setw(15) << "Event Date"
+        << setw(20) << "Package Type"
+        << setw(10) << "Guests"
+        << setw(15) << "Package Price"
+        << setw(20) << "Advt. Price"
+        << setw(15) << "Member Status" << "\n";
+    cout << "-------------------------------------------------------------------------------------------------------------\n";
+    ReportTotals totals = ReportTotals();
+    for (size_t s = 0; s < view->segments.size(); ++s) {
+        const RegistrationStore::Segment& segment = *view->segments[s];
+        for (int i = 0; i < segment.count; ++i) {
+            const Registration& registration = segment.items[i];
+            cout << left << setw(15) << registration.userName
+                << setw(15) << registration.eventDate
+                << setw(20) << registration.packageType
+                << setw(10) << registration.numGuests
+                << setw(15) << fixed << setprecision(2) << registration.packagePrice
+                << setw(20) << registration.advertisementPrice
+                << setw(15) << (registration.isMember ? "Member" : "Non-Member") << "\n";
+            addToTotals(totals, registration);
+        }
+    }
+    cout << "-------------------------------------------------------------------------------------------------------------\n";
+    cout << "Total Events: " << view->count << "\n";
+    cout << "Total Guests: " << totals.guests << "\n";
+    cout << "Total Revenue: RM" << fixed << setprecision(2) << totals.revenue << "\n";
+    cout << "Members: " << totals.members << " | Non-Members: " << totals.registrations - totals.members << "\n";
+    cout << "Package Sales Breakdown:\n";
+    for (const auto& package : totals.packageSales) {
+        cout << " - " << package.first << ": " << package.second << " sales\n";
+    }
+    analytics.display();
+    cout << "-------------------------------------------------------------------------------------------------------------\n";
+}
@@ -0,0 +1,1095 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <map>      // For membership levels
+#include <iomanip>  // For output manipulators
+#include <vector>   // For bulk reschedule plans
+#include <cstdio>   // For date parsing
+#include <memory>   // For shared registration segments
+#include <mutex>    // For serialising registration writers
+#include <algorithm> // For sketch compaction
+#include <cmath>    // For HyperLogLog estimates
+#include <cstdint>
+#include <cctype>   // For search normalisation
+#include <unordered_map>
+#include <unordered_set> // For search candidates
+#include <queue>    // For date waitlists
+#include <sstream>  // For state checksums
+#include <chrono>   // For the loyalty clock
+
+#include "input_reader.h"
+#include "loyalty.h"
+#include "outbox.h"
+#include "session_arena.h"
+#include "stage_timer.h"
+
+using namespace std;
+
+const int MAX_EVENTS = 100;          // Maximum number of events a user can register for
+const int MAX_INTERACTIONS = 100;    // Maximum number of interactions
+const int MAX_PACKAGES = 10;         // Maximum number of packages
+const int MAX_ADVERTISEMENTS = 10;   // Maximum number of advertisements
+
+class Event; // Forward declaration
+
+// Convert a "YYYY-MM-DD" date into a day number so the calendar can be walked day by day. Years
+// past 9999 take more digits, both here and in formatDate().
+bool parseDate(const string& date, int& dayNumber);
+
+// Convert a day number back into the "YYYY-MM-DD" form used as the booking key.
+string formatDate(int dayNumber);
+
+// Day number of today's date (UTC).
+int todayDayNumber();
+
+struct Registration {
+    string userName;
+    string email;
+    string eventDate;
+    string packageType;
+    int numGuests;
+    double packagePrice;
+    double advertisementPrice;
+    bool isMember;
+};
+
+// Registrations are kept in fixed-size segments. A report takes a snapshot, which is just a list
+// of segment pointers; writers copy a segment before changing it whenever a snapshot still holds
+// it. Reports therefore see a point-in-time view without ever blocking bookings, and a segment
+// is freed when the last snapshot referring to it goes away.
+class RegistrationStore {
+public:
+    static const int SEGMENT_SIZE = 64;
+
+    struct Segment {
+        Registration items[SEGMENT_SIZE];
+        int count;
+
+        Segment() : count(0) {
+        }
+    };
+
+    struct Snapshot {
+        vector<shared_ptr<const Segment>> segments;
+        int count;
+    };
+
+    // A registration whose event date was changed, as reported by rescheduleDates.
+    struct MovedBooking {
+        string email;
+        string oldDate;
+        string newDate;
+    };
+
+    RegistrationStore() : count(0) {
+    }
+
+    void append(const Registration& registration) {
+        lock_guard<mutex> lock(writeMutex);
+        if (segments.empty() || segments.back()->count == SEGMENT_SIZE) {
+            segments.push_back(make_shared<Segment>());
+        }
+        Segment& tail = writable(segments.size() - 1);
+        tail.items[tail.count++] = registration;
+        positionsByDate[registration.eventDate].push_back(count);
+        count++;
+    }
+
+    // Rename event dates, e.g. after a reschedule, and return the registrations that moved. Only
+    // the registrations on the moved dates are touched, found through the per-date position index.
+    vector<MovedBooking> rescheduleDates(const map<string, string>& newDates) {
+        lock_guard<mutex> lock(writeMutex);
+        vector<MovedBooking> bookings;
+        // Detach every affected position list first so that chained moves (A to B, B to C) stay correct.
+        vector<pair<map<string, string>::const_iterator, vector<int>>> moved;
+        for (map<string, string>::const_iterator it = newDates.begin(); it != newDates.end(); ++it) {
+            unordered_map<string, vector<int>>::iterator found = positionsByDate.find(it->first);
+            if (found == positionsByDate.end()) {
+                continue;
+            }
+            moved.push_back(make_pair(it, vector<int>()));
+            moved.back().second.swap(found->second);
+            positionsByDate.erase(found);
+        }
+        for (size_t m = 0; m < moved.size(); ++m) {
+            const string& oldDate = moved[m].first->first;
+            const string& newDate = moved[m].first->second;
+            const vector<int>& positions = moved[m].second;
+            for (size_t p = 0; p < positions.size(); ++p) {
+                Registration& registration = writable(positions[p] / SEGMENT_SIZE).items[positions[p] % SEGMENT_SIZE];
+                registration.eventDate = newDate;
+                MovedBooking booking = { registration.email, oldDate, newDate };
+                bookings.push_back(booking);
+            }
+            vector<int>& target = positionsByDate[newDate];
+            target.insert(target.end(), positions.begin(), positions.end());
+        }
+        return bookings;
+    }
+
+    shared_ptr<const Snapshot> snapshot() const {
+        shared_ptr<Snapshot> view = make_shared<Snapshot>();
+        lock_guard<mutex> lock(writeMutex);
+        view->segments.assign(segments.begin(), segments.end());
+        view->count = count;
+        return view;
+    }
+
+private:
+    // Copy-on-write: a segment still referenced by a snapshot is cloned before it is modified.
+    // New snapshots are only taken under writeMutex, so use_count() cannot grow behind our back.
+    Segment& writable(size_t index) {
+        if (segments[index].use_count() > 1) {
+            segments[index] = make_shared<Segment>(*segments[index]);
+        }
+        return *segments[index];
+    }
+
+    mutable mutex writeMutex;
+    vector<shared_ptr<Segment>> segments;
+    unordered_map<string, vector<int>> positionsByDate;
+    int count;
+};
+
+// 64-bit FNV-1a followed by a finaliser so that nearby keys spread over all bits.
+uint64_t hashKey(string_view key);
+
+// Id of a notification: its facts plus a per-send sequence, so that sending the same message
+// again is not mistaken for a retry of the first send.
+uint64_t notificationId(string_view facts);
+
+// HyperLogLog distinct counter: 4096 one-byte registers, about 1.6% standard error.
+class HyperLogLog {
+public:
+    static const int PRECISION = 12;
+    static const int REGISTERS = 1 << PRECISION;
+
+    HyperLogLog() : registers(REGISTERS, 0) {
+    }
+
+    void add(const string& key) {
+        uint64_t h = hashKey(key);
+        int index = static_cast<int>(h >> (64 - PRECISION));
+        uint64_t rest = (h << PRECISION) | (1ULL << (PRECISION - 1));
+        unsigned char rank = 1;
+        while ((rest & (1ULL << 63)) == 0) {
+            rest <<= 1;
+            rank++;
+        }
+        registers[index] = max(registers[index], rank);
+    }
+
+    void merge(const HyperLogLog& other) {
+        for (int i = 0; i < REGISTERS; ++i) {
+            registers[i] = max(registers[i], other.registers[i]);
+        }
+    }
+
+    double estimate() const {
+        double sum = 0.0;
+        int zeros = 0;
+        for (int i = 0; i < REGISTERS; ++i) {
+            sum += ldexp(1.0, -registers[i]);
+            zeros += registers[i] == 0;
+        }
+        double alpha = 0.7213 / (1.0 + 1.079 / REGISTERS);
+        double raw = alpha * REGISTERS * REGISTERS / sum;
+        if (raw <= 2.5 * REGISTERS && zeros > 0) {
+            return REGISTERS * log(static_cast<double>(REGISTERS) / zeros); // Linear counting for small sets
+        }
+        return raw;
+    }
+
+private:
+    vector<unsigned char> registers;
+};
+
+// KLL quantile sketch: a stack of compactors whose capacities shrink geometrically towards the
+// bottom. A full level is sorted and every other item is promoted with double weight.
+class QuantileSketch {
+public:
+    static const int K = 200;
+
+    QuantileSketch() : count(0), size(0), coin(0x9e3779b97f4a7c15ULL), levels(1) {
+    }
+
+    void add(double value) {
+        levels[0].push_back(value);
+        count++;
+        size++;
+        if (size >= totalCapacity()) {
+            compress();
+        }
+    }
+
+    void merge(const QuantileSketch& other) {
+        while (levels.size() < other.levels.size()) {
+            levels.push_back(vector<double>());
+        }
+        for (size_t h = 0; h < other.levels.size(); ++h) {
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+            size += static_cast<int>(other.levels[h].size());
+        }
+        count += other.count;
+        while (size >= totalCapacity()) {
+            compress();
+        }
+    }
+
+    // Value below which roughly a fraction q of all inserted values fall.
+    double quantile(double q) const {
+        vector<pair<double, long long>> weighted;
+        for (size_t h = 0; h < levels.size(); ++h) {
+            for (size_t i = 0; i < levels[h].size(); ++i) {
+                weighted.push_back(make_pair(levels[h][i], 1LL << h));
+            }
+        }
+        if (weighted.empty()) {
+            return 0.0;
+        }
+        sort(weighted.begin(), weighted.end());
+        long long total = 0;
+        for (size_t i = 0; i < weighted.size(); ++i) {
+            total += weighted[i].second;
+        }
+        long long rank = static_cast<long long>(q * total);
+        long long seen = 0;
+        for (size_t i = 0; i < weighted.size(); ++i) {
+            seen += weighted[i].second;
+            if (seen > rank) {
+                return weighted[i].first;
+            }
+        }
+        return weighted.back().first;
+    }
+
+    long long totalCount() const {
+        return count;
+    }
+
+private:
+    int capacity(size_t level) const {
+        int depth = static_cast<int>(levels.size() - level - 1);
+        return max(8, static_cast<int>(K * pow(2.0 / 3.0, depth)));
+    }
+
+    int totalCapacity() const {
+        int total = 0;
+        for (size_t h = 0; h < levels.size(); ++h) {
+            total += capacity(h);
+        }
+        return total;
+    }
+
+    void compress() {
+        for (size_t h = 0; h < levels.size(); ++h) {
+            if (static_cast<int>(levels[h].size()) < capacity(h)) {
+                continue;
+            }
+            if (h + 1 == levels.size()) {
+                levels.push_back(vector<double>());
+            }
+            vector<double>& level = levels[h];
+            sort(level.begin(), level.end());
+            coin ^= coin << 13;
+            coin ^= coin >> 7;
+            coin ^= coin << 17;
+            size_t offset = coin & 1;
+            size_t kept = 0;
+            for (size_t i = offset; i < level.size(); i += 2) {
+                levels[h + 1].push_back(level[i]);
+                kept++;
+            }
+            size -= static_cast<int>(level.size() - kept);
+            level.clear();
+            return;
+        }
+    }
+
+    long long count;
+    int size;
+    uint64_t coin;
+    vector<vector<double>> levels;
+};
+
+// Space-saving heavy hitters: a fixed set of counters, where a new key takes over the smallest.
+class TopKCounter {
+public:
+    static const int CAPACITY = 32;
+
+    void add(const string& key, long long weight = 1) {
+        for (size_t i = 0; i < counters.size(); ++i) {
+            if (counters[i].key == key) {
+                counters[i].count += weight;
+                return;
+            }
+        }
+        if (counters.size() < CAPACITY) {
+            Counter counter = { key, weight, 0 };
+            counters.push_back(counter);
+            return;
+        }
+        size_t smallest = 0;
+        for (size_t i = 1; i < counters.size(); ++i) {
+            if (counters[i].count < counters[smallest].count) {
+                smallest = i;
+            }
+        }
+        Counter& victim = counters[smallest];
+        victim.error = victim.count;
+        victim.count += weight;
+        victim.key = key;
+    }
+
+    void merge(const TopKCounter& other) {
+        for (size_t i = 0; i < other.counters.size(); ++i) {
+            add(other.counters[i].key, other.counters[i].count);
+        }
+    }
+
+    // Take back counts for a key, e.g. when a booking leaves its date. Untracked keys are ignored.
+    void remove(const string& key, long long weight = 1) {
+        for (size_t i = 0; i < counters.size(); ++i) {
+            if (counters[i].key == key) {
+                counters[i].count -= weight;
+                if (counters[i].count <= 0) {
+                    counters.erase(counters.begin() + i); // Frees the slot for another key
+                }
+                return;
+            }
+        }
+    }
+
+    // The k keys with the highest counts, largest first.
+    vector<pair<string, long long>> top(size_t k) const {
+        vector<pair<string, long long>> result;
+        for (size_t i = 0; i < counters.size(); ++i) {
+            result.push_back(make_pair(counters[i].key, counters[i].count));
+        }
+        sort(result.begin(), result.end(), [](const pair<string, long long>& a, const pair<string, long long>& b) {
+            return a.second > b.second;
+        });
+        if (result.size() > k) {
+            result.resize(k);
+        }
+        return result;
+    }
+
+private:
+    struct Counter {
+        string key;
+        long long count;
+        long long error; // Overestimate inherited from the evicted key
+    };
+    vector<Counter> counters;
+};
+
+// Streaming statistics maintained as registrations arrive, so finance reports never need a
+// full scan: distinct customers per month, guest-count percentiles per package and the most
+// requested dates. Every sketch has bounded size and can be merged with another instance.
+//
+// Rescheduled bookings move their date counts. A distinct-customer estimate cannot forget a
+// customer, so a booking moved to another month counts in both.
+class BookingAnalytics {
+public:
+    void record(const Registration& registration) {
+        lock_guard<mutex> lock(sketchMutex);
+        customersPerMonth[registration.eventDate.substr(0, 7)].add(registration.email);
+        guestsPerPackage[registration.packageType].add(registration.numGuests);
+        popularDates.add(registration.eventDate);
+    }
+
+    // Guest counts do not depend on the date, so only the date sketches change.
+    void recordMoves(const vector<RegistrationStore::MovedBooking>& moved) {
+        lock_guard<mutex> lock(sketchMutex);
+        for (size_t i = 0; i < moved.size(); ++i) {
+            popularDates.remove(moved[i].oldDate);
+            popularDates.add(moved[i].newDate);
+            customersPerMonth[moved[i].newDate.substr(0, 7)].add(moved[i].email);
+        }
+    }
+
+    void merge(const BookingAnalytics& other) {
+        lock_guard<mutex> lock(sketchMutex);
+        lock_guard<mutex> otherLock(other.sketchMutex);
+        for (map<string, HyperLogLog>::const_iterator it = other.customersPerMonth.begin(); it != other.customersPerMonth.end(); ++it) {
+            customersPerMonth[it->first].merge(it->second);
+        }
+        for (map<string, QuantileSketch>::const_iterator it = other.guestsPerPackage.begin(); it != other.guestsPerPackage.end(); ++it) {
+            guestsPerPackage[it->first].merge(it->second);
+        }
+        popularDates.merge(other.popularDates);
+    }
+
+    void display() const {
+        lock_guard<mutex> lock(sketchMutex);
+        cout << "Distinct Customers per Month (estimated; a booking moved across months counts in both):\n";
+        for (map<string, HyperLogLog>::const_iterator it = customersPerMonth.begin(); it != customersPerMonth.end(); ++it) {
+            cout << " - " << it->first << ": " << fixed << setprecision(0) << it->second.estimate() << "\n";
+        }
+        cout << "Guest Count Percentiles per Package (p50 / p95 / p99):\n";
+        for (map<string, QuantileSketch>::const_iterator it = guestsPerPackage.begin(); it != guestsPerPackage.end(); ++it) {
+            cout << " - " << it->first << ": " << fixed << setprecision(0)
+                << it->second.quantile(0.50) << " / " << it->second.quantile(0.95) << " / " << it->second.quantile(0.99) << "\n";
+        }
+        cout << "Most Requested Dates:\n";
+        vector<pair<string, long long>> dates = popularDates.top(5);
+        for (size_t i = 0; i < dates.size(); ++i) {
+            cout << " - " << dates[i].first << ": " << dates[i].second << " bookings\n";
+        }
+    }
+
+private:
+    mutable mutex sketchMutex;
+    map<string, HyperLogLog> customersPerMonth;
+    map<string, QuantileSketch> guestsPerPackage;
+    TopKCounter popularDates;
+};
+
+struct EventSchedule {
+    string time;
+    string activity;
+    string responsiblePerson;
+};
+
+class User {
+public:
+    string name;
+    string email;
+    string contact;
+    string eventDate;
+    int numGuests;           // Number of guests the user is bringing
+    string packageType;
+    bool isMember;           // Indicates if the user is a member
+    string pastEvents[MAX_EVENTS];
+    string pastEventPackages[MAX_EVENTS];
+    int pastEventCount;
+    string interactions[MAX_INTERACTIONS];
+    int interactionCount;
+    int loyaltyPoints;
+
+    User(const string& name = "", const string& email = "", const string& contact = "", const string& packageType = "", int numGuests = 0, bool isMember = false)
+        : name(name), email(email), contact(contact), packageType(packageType), numGuests(numGuests), isMember(isMember), loyaltyPoints(0), pastEventCount(0), interactionCount(0) {
+    }
+
+    // Record any event the user has registered for, including the event name and date.
+    // Returns the entry's index, or -1 if the history is full and the event was not recorded.
+    int addEvent(string_view eventName, const string& packageType) {
+        if (pastEventCount >= MAX_EVENTS) {
+            return -1;
+        }
+        pastEvents[pastEventCount] = eventName;
+        pastEventPackages[pastEventCount] = packageType;
+        return pastEventCount++;
+    }
+
+    // Update the event date for a specific event
+    void updateEventDate(int eventIndex, const string& newDate) {
+        if (eventIndex >= 0 && eventIndex < pastEventCount) {
+            pastEvents[eventIndex].assign("Event on ").append(newDate);
+        }
+    }
+
+    // Record the interaction of the user registering for an event.
+    void addInteraction(const string& interaction) {
+        if (interactionCount < MAX_INTERACTIONS) {
+            interactions[interactionCount++] = interaction;
+        }
+    }
+
+    void displayProfile() const {
+        cout << "\n-------- Customer Profile --------\n";
+        cout << "Name: " << name << "\n";
+        cout << "Email: " << email << "\n";
+        cout << "Loyalty Points: " << loyaltyPoints << "\n";
+        cout << "Past Events:\n";
+        for (int i = 0; i < pastEventCount; ++i) {
+            cout << " - " << pastEvents[i] << " (" << pastEventPackages[i] << ")\n";
+        }
+        cout << "----------------------------------\n";
+    }
+};
+
+
+
+
+// Search index over customer name, email and contact. Every term is kept in a sorted map for
+// prefix lookups and split into trigrams for typo-tolerant matching; trigram hits only select
+// candidates, which are then confirmed with a bounded edit distance. Each customer appears at
+// most once per trigram, in id order, and an update takes the old details out of every list.
+class CustomerIndex {
+public:
+    struct Customer {
+        string name;
+        string email;
+        string contact;
+    };
+
+    // Insert or refresh a customer, keyed by email.
+    void update(const User& user) {
+        pmr::string key = normalise(user.email);
+        if (key.empty()) {
+            return;
+        }
+        int id;
+        map<string, int, less<>>::const_iterator found = byEmail.find(string_view(key));
+        if (found != byEmail.end()) {
+            id = found->second;
+            removeTerms(id);
+        }
+        else {
+            id = static_cast<int>(customers.size());
+            customers.push_back(Customer());
+            byEmail.emplace(string(key), id);
+        }
+        customers[id].name = user.name;
+        customers[id].email = user.email;
+        customers[id].contact = user.contact;
+        addTerms(id);
+    }
+
+    // Exact prefix matches first, then close misspellings, at most `limit` customers.
+    vector<int> search(const string& query, size_t limit) const {
+        vector<int> result;
+        pmr::string needle = normalise(query);
+        if (needle.empty()) {
+            return result;
+        }
+
+        // Customers already returned or checked; it grows with the candidates, not the index
+        pmr::unordered_set<int> taken(sessionMemory());
+        taken.reserve(limit + MAX_VERIFIED);
+        for (map<string, vector<int>, less<>>::const_iterator it = prefixes.lower_bound(string_view(needle));
+            it != prefixes.end() && it->first.compare(0, needle.size(), needle) == 0 && result.size() < limit; ++it) {
+            for (size_t i = 0; i < it->second.size() && result.size() < limit; ++i) {
+                if (taken.insert(it->second[i]).second) {
+                    result.push_back(it->second[i]);
+                }
+            }
+        }
+
+        // A swap of neighbours is one edit but breaks up to four trigrams, so the query is also
+        // looked up with each pair swapped; a name typed that way shares all of the swapped grams
+        int maxEdits = needle.size() <= 4 ? 1 : 2;
+        size_t verified = 0;
+        addCloseMatches(needle, needle, 2, maxEdits, limit, taken, verified, result);
+        for (size_t i = 0; i + 1 < needle.size() && result.size() < limit && verified < MAX_VERIFIED; ++i) {
+            if (needle[i] != needle[i + 1]) {
+                pmr::string swapped = needle;
+                swap(swapped[i], swapped[i + 1]);
+                addCloseMatches(needle, swapped, 0, maxEdits, limit, taken, verified, result);
+            }
+        }
+        return result;
+    }
+
+    const Customer& customer(int id) const {
+        return customers[id];
+    }
+
+    size_t size() const {
+        return customers.size();
+    }
+
+    // Ids held across all trigram postings, for sizing the index.
+    size_t postingEntries() const {
+        size_t entries = 0;
+        for (unordered_map<string, vector<int>>::const_iterator it = postings.begin(); it != postings.end(); ++it) {
+            entries += it->second.size();
+        }
+        return entries;
+    }
+
+private:
+    // Temporaries below come from the session arena; only the index itself lives on the heap.
+    static pmr::string normalise(string_view text) {
+        pmr::string result(sessionMemory());
+        for (size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (!isspace(c)) {
+                result += static_cast<char>(tolower(c));
+            }
+        }
+        return result;
+    }
+
+    // The full name, each word of it, the email, its local part and the contact number.
+    static pmr::vector<pmr::string> terms(const Customer& customer) {
+        pmr::vector<pmr::string> result(sessionMemory());
+        pmr::string word(sessionMemory());
+        for (size_t i = 0; i <= customer.name.size(); ++i) {
+            if (i == customer.name.size() || isspace(static_cast<unsigned char>(customer.name[i]))) {
+                if (!word.empty()) {
+                    result.push_back(normalise(word));
+                }
+                word.clear();
+            }
+            else {
+                word += customer.name[i];
+            }
+        }
+        pmr::string fullName = normalise(customer.name);
+        if (result.size() > 1) {
+            result.push_back(fullName);
+        }
+        pmr::string email = normalise(customer.email);
+        if (!email.empty()) {
+            result.push_back(email);
+            size_t at = email.find('@');
+            if (at != string::npos && at > 0) {
+                result.emplace_back(string_view(email).substr(0, at));
+            }
+        }
+        pmr::string contact(sessionMemory());
+        for (size_t i = 0; i < customer.contact.size(); ++i) {
+            if (isdigit(static_cast<unsigned char>(customer.contact[i]))) {
+                contact += customer.contact[i];
+            }
+        }
+        if (!contact.empty()) {
+            result.push_back(contact);
+        }
+        return result;
+    }
+
+    // Trigrams padded at the front only, so a prefix shares all its trigrams with the full term.
+    static pmr::vector<pmr::string> trigrams(string_view term) {
+        pmr::vector<pmr::string> result(sessionMemory());
+        pmr::string padded("$$", sessionMemory());
+        padded += term;
+        for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+            result.emplace_back(string_view(padded).substr(i, 3));
+        }
+        return result;
+    }
+
+    // Edit distance counting swapped neighbours as one edit, giving up once it must exceed `bound`.
+    static int editDistance(string_view a, string_view b, int bound) {
+        if (abs(static_cast<int>(a.size()) - static_cast<int>(b.size())) > bound) {
+            return bound + 1;
+        }
+        pmr::vector<int> beforePrevious(b.size() + 1, 0, sessionMemory());
+        pmr::vector<int> previous(b.size() + 1, 0, sessionMemory());
+        pmr::vector<int> current(b.size() + 1, 0, sessionMemory());
+        for (size_t j = 0; j <= b.size(); ++j) {
+            previous[j] = static_cast<int>(j);
+        }
+        for (size_t i = 1; i <= a.size(); ++i) {
+            current[0] = static_cast<int>(i);
+            int rowBest = current[0];
+            for (size_t j = 1; j <= b.size(); ++j) {
+                int substitution = previous[j - 1] + (a[i - 1] != b[j - 1]);
+                current[j] = min(substitution, min(previous[j], current[j - 1]) + 1);
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                    current[j] = min(current[j], beforePrevious[j - 2] + 1);
+                }
+                rowBest = min(rowBest, current[j]);
+            }
+            if (rowBest > bound) {
+                return bound + 1;
+            }
+            swap(beforePrevious, previous);
+            swap(previous, current);
+        }
+        return previous[b.size()];
+    }
+
+    // Add customers within `maxEdits` of `needle` that lack at most `missing` of `variant`'s
+    // trigrams. Such a customer is on one of the (missing + 1) shortest posting lists; the lists
+    // are in id order, so the trigrams it shares are counted with a binary search on each.
+    void addCloseMatches(string_view needle, string_view variant, int missing, int maxEdits, size_t limit,
+        pmr::unordered_set<int>& taken, size_t& verified, vector<int>& result) const {
+        pmr::vector<pmr::string> grams = trigrams(variant);
+        int required = max(1, static_cast<int>(grams.size()) - missing);
+        pmr::vector<const vector<int>*> lists(sessionMemory());
+        for (size_t g = 0; g < grams.size(); ++g) {
+            unordered_map<string, vector<int>>::const_iterator posting = postings.find(string(grams[g])); // Short enough to stay off the heap
+            lists.push_back(posting == postings.end() ? &noPostings : &posting->second);
+        }
+        sort(lists.begin(), lists.end(), [](const vector<int>* a, const vector<int>* b) {
+            return a->size() < b->size();
+        });
+
+        size_t scanned = grams.size() - required + 1;
+        size_t candidates = 0;
+        for (size_t l = 0; l < scanned; ++l) {
+            for (size_t i = 0; i < lists[l]->size(); ++i) {
+                if (result.size() >= limit || verified >= MAX_VERIFIED || candidates++ >= MAX_CANDIDATES) {
+                    return;
+                }
+                int id = (*lists[l])[i];
+                if (taken.count(id) != 0) {
+                    continue;
+                }
+                int shared = 0;
+                for (size_t other = 0; other < lists.size() && shared < required && shared + static_cast<int>(lists.size() - other) >= required; ++other) {
+                    shared += binary_search(lists[other]->begin(), lists[other]->end(), id);
+                }
+                if (shared < required) {
+                    continue;
+                }
+
+                // Sharing trigrams only makes a candidate; the edit distance decides whether it matches.
+                taken.insert(id);
+                verified++;
+                pmr::vector<pmr::string> current = terms(customers[id]);
+                for (size_t t = 0; t < current.size(); ++t) {
+                    string_view term = current[t];
+                    // A term read as a prefix of the query must start like it
+                    if (editDistance(needle, term, maxEdits) <= maxEdits ||
+                        (term.size() > needle.size() && term[0] == needle[0] &&
+                        editDistance(needle, term.substr(0, needle.size()), maxEdits) <= maxEdits)) {
+                        result.push_back(id);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Every trigram of every term, each once.
+    static pmr::vector<pmr::string> trigramsOf(const pmr::vector<pmr::string>& current) {
+        pmr::vector<pmr::string> grams(sessionMemory());
+        for (size_t t = 0; t < current.size(); ++t) {
+            pmr::vector<pmr::string> termGrams = trigrams(current[t]);
+            grams.insert(grams.end(), termGrams.begin(), termGrams.end());
+        }
+        sort(grams.begin(), grams.end());
+        grams.erase(unique(grams.begin(), grams.end()), grams.end());
+        return grams;
+    }
+
+    void addTerms(int id) {
+        pmr::vector<pmr::string> current = terms(customers[id]);
+        for (size_t t = 0; t < current.size(); ++t) {
+            map<string, vector<int>, less<>>::iterator entry = prefixes.find(string_view(current[t]));
+            if (entry == prefixes.end()) {
+                entry = prefixes.emplace(string(current[t]), vector<int>()).first;
+            }
+            entry->second.push_back(id);
+        }
+        pmr::vector<pmr::string> grams = trigramsOf(current);
+        for (size_t g = 0; g < grams.size(); ++g) {
+            vector<int>& posting = postings[string(grams[g])];
+            posting.insert(lower_bound(posting.begin(), posting.end(), id), id); // New customers go on the end
+        }
+    }
+
+    void removeTerms(int id) {
+        pmr::vector<pmr::string> current = terms(customers[id]);
+        for (size_t t = 0; t < current.size(); ++t) {
+            map<string, vector<int>, less<>>::iterator entry = prefixes.find(string_view(current[t]));
+            if (entry == prefixes.end()) {
+                continue;
+            }
+            entry->second.erase(remove(entry->second.begin(), entry->second.end(), id), entry->second.end());
+            if (entry->second.empty()) {
+                prefixes.erase(entry);
+            }
+        }
+        pmr::vector<pmr::string> grams = trigramsOf(current);
+        for (size_t g = 0; g < grams.size(); ++g) {
+            unordered_map<string, vector<int>>::iterator posting = postings.find(string(grams[g]));
+            if (posting == postings.end()) {
+                continue;
+            }
+            vector<int>::iterator entry = lower_bound(posting->second.begin(), posting->second.end(), id);
+            if (entry != posting->second.end() && *entry == id) {
+                posting->second.erase(entry);
+            }
+            if (posting->second.empty()) {
+                postings.erase(posting);
+            }
+        }
+    }
+
+    static const size_t MAX_CANDIDATES = 2048; // Posting entries counted per lookup
+    static const size_t MAX_VERIFIED = 256;    // Candidates checked by edit distance per search
+
+    vector<Customer> customers;
+    map<string, int, less<>> byEmail;
+    map<string, vector<int>, less<>> prefixes;
+    unordered_map<string, vector<int>> postings;
+    const vector<int> noPostings;
+};
+
+class Event {
+private:
+    int maxGuests;                      // Total maximum guests allowed for the event
+    map<string, string> packageThemes;
+    map<string, bool> bookedDates; // Map to store booked dates
+
+    // Registration data for report generation
+    RegistrationStore registrations;
+    BookingAnalytics analytics;
+    CustomerIndex customers;
+    LoyaltyLedger loyalty;
+
+    // A customer waiting for a fully booked date, holding the package they chose.
+    struct WaitlistEntry {
+        int tierRank;
+        long long sequence; // Order in which customers joined
+        Registration booking;
+        string contact;
+    };
+
+    // Higher membership level first, then first come, first served.
+    struct WaitlistOrder {
+        bool operator()(const WaitlistEntry& a, const WaitlistEntry& b) const {
+            if (a.tierRank != b.tierRank) {
+                return a.tierRank < b.tierRank;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+
+    typedef priority_queue<WaitlistEntry, vector<WaitlistEntry>, WaitlistOrder> Waitlist;
+    map<string, Waitlist> waitlists;
+    long long waitlistSequence;
+
+    void joinWaitlist(User& user);
+    // `current` is the customer logged in on this console, who may be the one promoted.
+    void releaseDate(User& current, const string& date);
+
+    // Point the history of each moved booking's owner at its new date.
+    void moveHistory(User& current, const vector<RegistrationStore::MovedBooking>& moved);
+
+    // One planned move of a booked date during a bulk reschedule
+    struct DateMove {
+        string oldDate;
+        string newDate;
+    };
+
+
+public:
+    Event(int maxGuests = 500);
+
+    // packageEvents[i] is the index in user.pastEvents of the booking charged at packagePrices[i].
+    void registration(User& user, double packagePrices[], int packageEvents[], int& packageCount, double advertisementPrices[], int& advertisementCount);
+
+    // Non-interactive booking steps, shared by the menus and by scripted clients such as the benchmark.
+    bool isDateBooked(const string& date) const;
+    bool book(User& user, double packagePrice, double advertisementPrice);
+    // False if nothing is booked on oldDate or newDate is already booked.
+    bool rescheduleDate(User& current, const string& oldDate, const string& newDate);
+    void recordRegistration(const Registration& record);
+
+    // Queue the confirmation email; it is sent by the notification outbox, not on the booking path.
+    void sendConfirmation(const User& user) {
+        DD_TIME_STAGE(STAGE_CONFIRMATION);
+        Notification confirmation;
+        pmr::string key("confirmation|", sessionMemory());
+        key.append(user.email).append("|").append(user.eventDate);
+        confirmation.id = notificationId(key);
+        confirmation.kind = NOTIFY_CONFIRMATION;
+        confirmation.email = user.email;
+        confirmation.name = user.name;
+        confirmation.eventDates = user.eventDate;
+        confirmation.amount = 0.0;
+        queueNotification(confirmation);
+        cout << "A confirmation for " << user.eventDate << " will be emailed to " << user.email << ".\n";
+    }
+
+
+    // Prompt for a package; the choice is stored in chosenPackage and chosenGuests only if it succeeds.
+    double package(string& chosenPackage, int& chosenGuests);
+
+
+
+    void membership(User& user) {
+        refreshPoints(user);
+        cout << "\n-------- Membership Details --------\n";
+        cout << "Your current loyalty points: " << user.loyaltyPoints << "\n";
+        string level = membershipLevel(user.loyaltyPoints);
+        cout << "Your membership level: " << level << "\n";
+        cout << "You are entitled to a discount of " << setprecision(0) << currentPricing()->tierDiscounts[membershipRank(user.loyaltyPoints)] * 100 << "% on your total.\n";
+        cout << "------------------------------------\n";
+    }
+
+    double advertisement(const User& user, string_view babyName, string_view time, string_view location);
+
+    void manageDate(User& user) {
+        InputReader& input = consoleInput();
+        int eventNumber = 1;
+        pmr::vector<pmr::string> eventDates(sessionMemory()); // Event dates as listed
+        pmr::vector<pmr::string> eventPackages(sessionMemory()); // Event packages as listed
+        eventDates.reserve(user.pastEventCount);
+        eventPackages.reserve(user.pastEventCount);
+        int eventCount = 0;
+
+        // Display all booked events with numbers
+        cout << endl;
+        cout << "Booked Events:\n";
+        cout << "------------------------------------------------------\n";
+        cout << "|" << left << setw(5) << "No." << left << setw(23) << "Event Date" << "|" << setw(23) << "Package Name" << "|\n";
+        cout << "------------------------------------------------------\n";
+        for (int i = 0; i < user.pastEventCount; ++i) {
+            cout << "|" << left << setw(5) << eventNumber << left << setw(23) << user.pastEvents[i] << "|" << setw(23) << user.pastEventPackages[i] << "|\n";
+            eventDates.emplace_back(user.pastEvents[i]);
+            eventPackages.emplace_back(user.pastEventPackages[i]);
+            eventCount++;
+            eventNumber++;
+        }
+        cout << "-------------------------------------------------------\n";
+
+        // Check if there are no booked events
+        if (eventCount == 0) {
+            cout << "No events are currently booked.\n";
+            return;
+        }
+
+        while (true) {
+            // Ask if the staff wants to modify an event
+            cout << "Do you want to modify an event? (Y/N): ";
+            char modifyEvent;
+            if (input.readChar(modifyEvent) == INPUT_EOF) {
+                return;
+            }
+
+            if (modifyEvent != 'Y' && modifyEvent != 'y') {
+                cout << "No modifications made.\n";
+                break;
+            }
+
+            // Prompt staff to choose an event to modify
+            cout << "Enter the number of the event you want to modify: ";
+            int chosenEvent;
+            if (input.readInt(chosenEvent) == INPUT_EOF) {
+                return;
+            }
+
+            // Check if the chosen event number is valid
+            if (chosenEvent < 1 || chosenEvent > eventCount) {
+                cout << "Error: Invalid event number.\n";
+                return;
+            }
+
+            // Booked events are listed as "Event on <date>"
+            string_view listed = eventDates[chosenEvent - 1];
+            const string_view prefix = "Event on ";
+            if (listed.compare(0, prefix.size(), prefix) == 0) {
+                listed.remove_prefix(prefix.size());
+            }
+            string eventDate(listed);
+
+            // Prompt for new date
+            cout << "Enter the new date for the event (e.g., 2023-12-31): ";
+            string newDate;
+            if (input.readLine(newDate) == INPUT_EOF) {
+                return;
+            }
+
+            // Move the booking, unless it was released or the new date is already booked
+            if (!isDateBooked(eventDate)) {
+                cout << "Error: " << eventDate << " is no longer booked.\n";
+                return;
+            }
+            if (!rescheduleDate(user, eventDate, newDate)) {
+                cout << "Error: The new date is already booked. Please try again.\n";
+                return;
+            }
+            user.updateEventDate(chosenEvent - 1, newDate); // Update the event date
+            cout << "Event date updated successfully to " << newDate << ".\n";
+
+            // Ask if the staff wants to modify another event
+            cout << "Do you want to modify another event? (Y/N): ";
+            char modifyAnotherEvent;
+            if (input.readChar(modifyAnotherEvent) == INPUT_EOF) {
+                return;
+            }
+
+            if (modifyAnotherEvent != 'Y' && modifyAnotherEvent != 'y') {
+                break;
+            }
+        }
+
+        // Display the latest event details
+        cout << "\nLatest Event Details:\n";
+        cout << "------------------------------------------------------\n";
+        cout << "|" << left << setw(5) << "No." << left << setw(23) << "Event Date" << "|" << setw(23) << "Package Name" << "|\n";
+        cout << "------------------------------------------------------\n";
+        for (int i = 0; i < user.pastEventCount; ++i) {
+            cout << "|" << left << setw(5) << i + 1 << left << setw(23) << user.pastEvents[i] << "|" << setw(23) << user.pastEventPackages[i] << "|\n";
+        }
+        cout << "-------------------------------------------------------\n";
+    }
+
+
+    // Outcome of a bulk reschedule: the moves applied, the bookings that could not be placed and
+    // the waitlist entries cancelled with the closed dates. Nothing is changed if `error` is set.
+    struct RescheduleResult {
+        vector<DateMove> moved;
+        vector<string> unplaced;
+        int cancelledWaits;
+        string error;
+    };
+
+    // `user` is the customer logged in on this console; every other owner's history is updated
+    // through the profile store.
+    RescheduleResult bulkReschedule(User& user, const string& closedFrom, const string& closedTo, const string& targetFrom, const string& targetTo);
+
+    void bulkRescheduleMenu(User& user);
+
+    void indexCustomer(const User& user) {
+        customers.update(user);
+    }
+
+    void customerSearch();
+
+    // Loyalty points live in the ledger, keyed by email; User::loyaltyPoints is a copy of the balance.
+    // Both catch the clock up first, so points that expired since the last tick are gone.
+    void awardPoints(User& user, int points) {
+        catchUpLoyaltyClock();
+        user.loyaltyPoints = loyalty.earn(user.email, points);
+    }
+
+    void refreshPoints(User& user) {
+        catchUpLoyaltyClock();
+        user.loyaltyPoints = loyalty.balance(user.email);
+    }
+
+    // Advance the loyalty clock from its last tick to today's date. A clock moved past today from
+    // the staff menu stays where it is until the calendar catches up.
+    void catchUpLoyaltyClock() {
+        int behind = todayDayNumber() - loyalty.today();
+        if (behind > 0) {
+            loyalty.advance(behind);
+        }
+    }
+
+    LoyaltyLedger::ExpiryReport advanceLoyaltyClock(int days) {
+        return loyalty.advance(days);
+    }
+
+    void loyaltyClockMenu();
+
+    // Totals for a set of bookings before any coupon is applied.
+    struct Quote {
+        double totalPackagePrice;
+        double totalAdvertisementPrice;
+        string level;
+        double membershipDiscount;
+        double amount; // After membership discount
+    };
+
+    Quote quote(const User& user, const double packagePrices[], int packageCount, const double advertisementPrices[], int advertisementCount) const;
+
+    void Payment(User& currentUser, const double packagePrices[], const int packageEvents[], int packageCount, const double advertisementPrices[], int advertisementCount);
+
+    // Totals over every registration, as printed at the end of generateReport().
+    struct ReportTotals {
+        long long registrations;
+        long long guests;
+        long long members;
+        double revenue;
+        map<string, int> packageSales;
+    };
+
+    ReportTotals reportTotals() const;
+    void generateReport();
+
+    // Fingerprint of every booked date and registration, for comparing runs and replays.
+    uint64_t stateChecksum() const;
+
+};
@@ -0,0 +1,189 @@
+#include "input_reader.h"
+#include "stage_timer.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+size_t FdSource::read(char* buffer, size_t capacity) {
+    while (true) {
+#ifdef _WIN32
+        int count = _read(fd, buffer, static_cast<unsigned int>(capacity));
+#else
+        ssize_t count = ::read(fd, buffer, capacity);
+#endif
+        if (count >= 0) {
+            return static_cast<size_t>(count);
+        }
+        if (errno != EINTR) {
+            return 0; // Treat read errors as the end of input
+        }
+    }
+}
+
+InputReader::InputReader(InputSource& source)
+    : source(source), tied(nullptr), observer(nullptr), buffer(BLOCK_SIZE), begin(0), end(0), sourceDone(false), atEnd(false) {
+}
+
+// Make room after the unread bytes and pull the next block from the source.
+bool InputReader::fill() {
+    if (sourceDone) {
+        return false;
+    }
+    if (begin > 0) {
+        memmove(&buffer[0], &buffer[begin], end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buffer.size()) {
+        buffer.resize(buffer.size() * 2); // A single line longer than the buffer
+    }
+    if (tied) {
+        tied->flush();
+    }
+    // Blocking on the user is not part of any stage's latency
+    bool timed = stageTimingEnabled();
+    chrono::steady_clock::time_point waitStart;
+    if (timed) {
+        waitStart = chrono::steady_clock::now();
+    }
+    size_t count = source.read(&buffer[end], buffer.size() - end);
+    if (timed) {
+        chrono::steady_clock::duration waited = chrono::steady_clock::now() - waitStart;
+        addInputWait(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(waited).count()));
+    }
+    if (count == 0) {
+        sourceDone = true;
+        return false;
+    }
+    end += count;
+    return true;
+}
+
+InputStatus InputReader::readLine(string_view& line) {
+    if (atEnd) {
+        return INPUT_EOF;
+    }
+
+    size_t scanned = begin;
+    const char* newline = nullptr;
+    while ((newline = static_cast<const char*>(memchr(&buffer[0] + scanned, '\n', end - scanned))) == nullptr) {
+        scanned = end - begin; // Offset survives the compaction in fill()
+        if (!fill()) {
+            break;
+        }
+        scanned += begin;
+    }
+
+    size_t lineEnd;
+    size_t next;
+    if (newline) {
+        lineEnd = newline - &buffer[0];
+        next = lineEnd + 1;
+    }
+    else if (begin < end) {
+        lineEnd = end; // Last line without a trailing newline
+        next = end;
+    }
+    else {
+        atEnd = true;
+        return INPUT_EOF;
+    }
+
+    size_t length = lineEnd - begin;
+    if (length > 0 && buffer[begin + length - 1] == '\r') {
+        length--;
+    }
+    line = string_view(&buffer[begin], length);
+    begin = next;
+
+    if (observer) {
+        observer->onLine(line);
+    }
+    return INPUT_OK;
+}
+
+InputStatus InputReader::readLine(string& line) {
+    string_view view;
+    InputStatus status = readLine(view);
+    line.assign(view.data(), view.size());
+    return status;
+}
+
+InputStatus InputReader::readLine(pmr::string& line) {
+    string_view view;
+    InputStatus status = readLine(view);
+    line.assign(view.data(), view.size());
+    return status;
+}
+
+InputStatus InputReader::readWord(string& word) {
+    string_view view;
+    InputStatus status = readLine(view);
+    size_t first = 0;
+    while (first < view.size() && isspace(static_cast<unsigned char>(view[first]))) {
+        first++;
+    }
+    size_t last = first;
+    while (last < view.size() && !isspace(static_cast<unsigned char>(view[last]))) {
+        last++;
+    }
+    word.assign(view.data() + first, last - first);
+    return status;
+}
+
+InputStatus InputReader::readChar(char& value) {
+    string word;
+    InputStatus status = readWord(word);
+    value = word.empty() ? '\0' : word[0];
+    return status;
+}
+
+InputStatus InputReader::readInt(int& value) {
+    value = 0;
+    string word;
+    InputStatus status = readWord(word);
+    if (status != INPUT_OK) {
+        return status;
+    }
+    char* parsedEnd = nullptr;
+    errno = 0;
+    long parsed = strtol(word.c_str(), &parsedEnd, 10);
+    if (word.empty() || *parsedEnd != '\0' || errno == ERANGE || parsed < INT32_MIN || parsed > INT32_MAX) {
+        return INPUT_INVALID;
+    }
+    value = static_cast<int>(parsed);
+    return INPUT_OK;
+}
+
+namespace {
+
+thread_local InputReader* activeReader = nullptr;
+
+}
+
+InputReader& consoleInput() {
+    if (activeReader) {
+        return *activeReader;
+    }
+    static FdSource stdinSource(0);
+    static InputReader stdinReader(stdinSource);
+    static bool tiedToConsole = false;
+    if (!tiedToConsole) {
+        stdinReader.tie(&cout);
+        tiedToConsole = true;
+    }
+    return stdinReader;
+}
+
+void setConsoleInput(InputReader* reader) {
+    activeReader = reader;
+}
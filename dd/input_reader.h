@@ -0,0 +1,100 @@
+#pragma once
+
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Where console input comes from: stdin, a session socket, or a recorded session.
+class InputSource {
+public:
+    virtual ~InputSource() {
+    }
+
+    // Copy up to `capacity` bytes into `buffer`, blocking until at least one is available.
+    // Returns 0 at end of input.
+    virtual size_t read(char* buffer, size_t capacity) = 0;
+};
+
+// Reads straight from a file descriptor (0 for stdin, or a connected socket).
+class FdSource : public InputSource {
+public:
+    explicit FdSource(int fd) : fd(fd) {
+    }
+
+    size_t read(char* buffer, size_t capacity) override;
+
+private:
+    int fd;
+};
+
+// Receives every line the reader hands out, e.g. to record a session.
+class LineObserver {
+public:
+    virtual ~LineObserver() {
+    }
+
+    virtual void onLine(string_view line) = 0;
+};
+
+enum InputStatus {
+    INPUT_OK,
+    INPUT_INVALID, // A line was read but did not parse; the value is reset
+    INPUT_EOF      // No more input; every later read also returns INPUT_EOF
+};
+
+// Line-oriented console input. Input is pulled from the source in large blocks and split into
+// lines in place, so a line is only copied when the caller asks for a string. Every prompt
+// consumes exactly one line and reports end of input or a parse failure through its status,
+// which lets the menus stop cleanly instead of looping on a dead stream.
+class InputReader {
+public:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    explicit InputReader(InputSource& source);
+
+    // Stream flushed before the reader blocks for more input, so prompts are visible.
+    void tie(ostream* stream) {
+        tied = stream;
+    }
+
+    void setObserver(LineObserver* lineObserver) {
+        observer = lineObserver;
+    }
+
+    // The view stays valid until the next read.
+    InputStatus readLine(string_view& line);
+    InputStatus readLine(string& line);
+    InputStatus readLine(pmr::string& line);
+    // First word of the line.
+    InputStatus readWord(string& word);
+    // First non-blank character of the line, or '\0' for a blank line.
+    InputStatus readChar(char& value);
+    // The line as a whole number, or 0 with INPUT_INVALID.
+    InputStatus readInt(int& value);
+
+    bool eof() const {
+        return atEnd;
+    }
+
+private:
+    bool fill();
+
+    InputSource& source;
+    ostream* tied;
+    LineObserver* observer;
+    vector<char> buffer;
+    size_t begin;
+    size_t end;
+    bool sourceDone;
+    bool atEnd;
+};
+
+// Reader used by the console menus of the current thread; defaults to stdin.
+InputReader& consoleInput();
+
+// Point this thread's console menus at another reader (nullptr restores stdin).
+void setConsoleInput(InputReader* reader);
@@ -0,0 +1,150 @@
+#include "loyalty.h"
+
+#include <cctype>
+
+string customerKey(const string& email) {
+    string key = email;
+    for (size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<char>(tolower(static_cast<unsigned char>(key[i])));
+    }
+    return key;
+}
+
+void TimingWheel::schedule(int tick, uint32_t item) {
+    Timer timer;
+    timer.tick = tick > current ? tick : current + 1;
+    timer.item = item;
+    place(timer);
+    pending++;
+}
+
+// Put a timer in the lowest level whose span, counted from now, reaches it.
+void TimingWheel::place(const Timer& timer) {
+    long long delta = static_cast<long long>(timer.tick) - current;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1LL << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    slots[level][(timer.tick >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(timer);
+}
+
+// When the clock enters a new slot at some level, spread that slot's timers over the levels
+// below. Higher levels go first, since their timers can land in lower slots due this same tick.
+void TimingWheel::cascade() {
+    int top = 0;
+    while (top < LEVELS - 1 && (current & ((1 << (SLOT_BITS * (top + 1))) - 1)) == 0) {
+        top++;
+    }
+    for (int level = top; level >= 1; --level) {
+        vector<Timer> moving;
+        moving.swap(slots[level][(current >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+        for (size_t i = 0; i < moving.size(); ++i) {
+            place(moving[i]);
+        }
+    }
+}
+
+LoyaltyLedger::LoyaltyLedger(int today) : wheel(today), pricingVersion(currentPricing()->version) {
+    for (int rank = 0; rank < MEMBERSHIP_TIERS; ++rank) {
+        tierCounts[rank] = 0;
+    }
+}
+
+const LoyaltyLedger::Account* LoyaltyLedger::find(const string& email) const {
+    unordered_map<string, int>::const_iterator found = customerIds.find(customerKey(email));
+    return found != customerIds.end() ? &accounts[found->second] : nullptr;
+}
+
+int LoyaltyLedger::balance(const string& email) const {
+    const Account* account = find(email);
+    return account ? account->balance : 0;
+}
+
+int LoyaltyLedger::tierRank(const string& email) const {
+    const Account* account = find(email);
+    if (!account) {
+        return 0;
+    }
+    shared_ptr<const PricingTable> pricing = currentPricing();
+    return pricing->version == pricingVersion ? account->tierRank : pricing->rank(account->balance);
+}
+
+void LoyaltyLedger::syncTiers(const PricingTable& pricing) {
+    if (pricing.version == pricingVersion) {
+        return;
+    }
+    pricingVersion = pricing.version;
+    for (size_t i = 0; i < accounts.size(); ++i) {
+        setBalance(pricing, accounts[i], accounts[i].balance);
+    }
+}
+
+void LoyaltyLedger::setBalance(const PricingTable& pricing, Account& account, int balance) {
+    account.balance = balance;
+    int rank = pricing.rank(balance);
+    if (rank != account.tierRank) {
+        tierCounts[account.tierRank]--;
+        tierCounts[rank]++;
+        account.tierRank = rank;
+    }
+}
+
+int LoyaltyLedger::earn(const string& email, int points) {
+    shared_ptr<const PricingTable> pricing = currentPricing();
+    syncTiers(*pricing);
+
+    pair<unordered_map<string, int>::iterator, bool> inserted =
+        customerIds.insert(make_pair(customerKey(email), static_cast<int>(accounts.size())));
+    if (inserted.second) {
+        Account account = { 0, 0, -1, 0 };
+        accounts.push_back(account);
+        tierCounts[0]++;
+    }
+    int customer = inserted.first->second;
+    Account& account = accounts[customer];
+
+    if (account.lastGrantDay == today()) {
+        grants[account.lastGrant].points += points;
+    }
+    else {
+        Grant grant = { customer, points };
+        uint32_t id;
+        if (!freeGrants.empty()) {
+            id = freeGrants.back();
+            freeGrants.pop_back();
+            grants[id] = grant;
+        }
+        else {
+            id = static_cast<uint32_t>(grants.size());
+            grants.push_back(grant);
+        }
+        wheel.schedule(today() + EXPIRY_DAYS, id);
+        account.lastGrantDay = today();
+        account.lastGrant = id;
+    }
+
+    setBalance(*pricing, account, account.balance + points);
+    return account.balance;
+}
+
+LoyaltyLedger::ExpiryReport LoyaltyLedger::advance(int days) {
+    ExpiryReport report = { 0, 0, 0 };
+    shared_ptr<const PricingTable> pricing = currentPricing();
+    syncTiers(*pricing);
+    wheel.advance(today() + days, [&](uint32_t id) {
+        const Grant& grant = grants[id];
+        Account& account = accounts[grant.customer];
+        int rank = account.tierRank;
+        setBalance(*pricing, account, account.balance - grant.points);
+        if (account.tierRank != rank) {
+            report.tierChanges++;
+        }
+        if (account.lastGrant == id) {
+            account.lastGrantDay = -1;
+        }
+        report.grants++;
+        report.points += grant.points;
+        freeGrants.push_back(id);
+    });
+    return report;
+}
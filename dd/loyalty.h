@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pricing.h"
+
+using namespace std;
+
+// Customers are identified by email without regard to case. Everything keyed by customer (the
+// loyalty ledger, the profile store, the login) goes through this one key.
+string customerKey(const string& email);
+
+// Hierarchical timing wheel over whole-number ticks. Level 0 has one slot per tick; each higher
+// level has slots 64 times wider. A timer sits in the lowest level whose span covers it and is
+// moved down one level when its slot comes round, so every timer is touched at most once per
+// level: scheduling and expiry are O(1) amortised, however many timers are pending.
+class TimingWheel {
+public:
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4; // 64^4 ticks, about 45,000 years of days
+
+    explicit TimingWheel(int now) : current(now), pending(0) {
+    }
+
+    int now() const {
+        return current;
+    }
+
+    size_t size() const {
+        return pending;
+    }
+
+    // Fire `item` at `tick`; ticks that have already passed fire on the next advance.
+    void schedule(int tick, uint32_t item);
+
+    // Move the clock forward to `tick`, calling expire(item) for every timer that falls due.
+    template <typename Expire>
+    void advance(int tick, Expire expire) {
+        while (current < tick) {
+            current++;
+            cascade();
+            vector<Timer>& due = slots[0][current & (SLOTS - 1)];
+            for (size_t i = 0; i < due.size(); ++i) {
+                expire(due[i].item);
+            }
+            pending -= due.size();
+            due.clear();
+        }
+    }
+
+private:
+    struct Timer {
+        int tick;
+        uint32_t item;
+    };
+
+    void place(const Timer& timer);
+    void cascade();
+
+    int current;
+    size_t pending;
+    vector<Timer> slots[LEVELS][SLOTS];
+};
+
+// Loyalty points per customer, kept as dated grants that expire EXPIRY_DAYS after they were
+// earned. Balances and tiers are cached per customer and adjusted as grants expire, so moving the
+// clock only touches the grants that fall due and the customers who own them. When the pricing
+// rules change the tier thresholds, the cached tiers are recomputed on the next update.
+class LoyaltyLedger {
+public:
+    static const int EXPIRY_DAYS = 365;
+
+    struct ExpiryReport {
+        long long grants;
+        long long points;
+        long long tierChanges;
+    };
+
+    explicit LoyaltyLedger(int today);
+
+    int today() const {
+        return wheel.now();
+    }
+
+    // Credit points earned today; returns the new balance.
+    int earn(const string& email, int points);
+
+    int balance(const string& email) const;
+
+    // Cached membership rank for the current balance.
+    int tierRank(const string& email) const;
+
+    // Move the clock forward by `days` and expire every grant that falls due.
+    ExpiryReport advance(int days);
+
+    long long customersInTier(int rank) const {
+        return tierCounts[rank];
+    }
+
+    size_t activeGrants() const {
+        return wheel.size();
+    }
+
+private:
+    struct Grant {
+        int customer;
+        int points;
+    };
+
+    struct Account {
+        int balance;
+        int tierRank;
+        int lastGrantDay; // Points earned on the same day share one grant
+        uint32_t lastGrant;
+    };
+
+    const Account* find(const string& email) const;
+    void setBalance(const PricingTable& pricing, Account& account, int balance);
+    void syncTiers(const PricingTable& pricing);
+
+    unordered_map<string, int> customerIds; // customerKey(email) -> account
+    vector<Account> accounts;
+    vector<Grant> grants;
+    vector<uint32_t> freeGrants;
+    TimingWheel wheel;
+    long long tierCounts[MEMBERSHIP_TIERS];
+    uint64_t pricingVersion; // Rules the cached tiers were computed under
+};
@@ -0,0 +1,329 @@
+#include "outbox.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+string idText(uint64_t id) {
+    char text[17];
+    snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(id));
+    return text;
+}
+
+// Journal fields are tab separated, one message per line.
+string journalField(const string& value) {
+    string field = value;
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '\t' || field[i] == '\n' || field[i] == '\r') {
+            field[i] = ' ';
+        }
+    }
+    return field;
+}
+
+const char* kindName(NotificationKind kind) {
+    switch (kind) {
+    case NOTIFY_INVOICE:
+        return "invoice";
+    case NOTIFY_PAYMENT_DUE:
+        return "payment-due";
+    default:
+        return "confirmation";
+    }
+}
+
+void writeJournalLine(ostream& out, const Notification& message) {
+    out << idText(message.id) << '\t' << kindName(message.kind) << '\t'
+        << journalField(message.email) << '\t' << journalField(message.name) << '\t'
+        << journalField(message.eventDates) << '\t' << fixed << setprecision(2) << message.amount << '\n';
+}
+
+bool parseJournalLine(const string& line, Notification& message) {
+    vector<string> fields;
+    stringstream in(line);
+    string field;
+    while (getline(in, field, '\t')) {
+        fields.push_back(field);
+    }
+    if (fields.size() != 6) {
+        return false; // Torn write at the end of the journal
+    }
+    message.id = strtoull(fields[0].c_str(), nullptr, 16);
+    message.kind = fields[1] == "invoice" ? NOTIFY_INVOICE : fields[1] == "payment-due" ? NOTIFY_PAYMENT_DUE : NOTIFY_CONFIRMATION;
+    message.email = fields[2];
+    message.name = fields[3];
+    message.eventDates = fields[4];
+    message.amount = atof(fields[5].c_str());
+    return true;
+}
+
+unique_ptr<NotificationOutbox> processOutbox;
+mutex processOutboxMutex;
+
+}
+
+string renderNotification(const Notification& message) {
+    ostringstream text;
+    text << "To: " << message.email << "\n";
+    if (message.kind == NOTIFY_CONFIRMATION) {
+        text << "Subject: Your event on " << message.eventDates << "\n\n";
+        text << "Dear " << message.name << ",\n";
+        text << "Thank you for registering for the event!\n";
+        text << "Your event will be held on " << message.eventDates << "!\n";
+        text << "We look forward to seeing you there.\n";
+    }
+    else if (message.kind == NOTIFY_PAYMENT_DUE) {
+        text << "Subject: Payment due for your event on " << message.eventDates << "\n\n";
+        text << "Dear " << message.name << ",\n";
+        text << "The date you were waiting for has become free and is now booked for you.\n";
+        text << "Your event will be held on " << message.eventDates << ".\n";
+        text << "Please contact us to pay the RM" << fixed << setprecision(2) << message.amount << " due.\n";
+    }
+    else {
+        text << "Subject: Your invoice\n\n";
+        text << "Dear " << message.name << ",\n";
+        text << "Thank you for your payment of RM" << fixed << setprecision(2) << message.amount << ".\n";
+        text << "Events: " << message.eventDates << "\n";
+    }
+    return text.str();
+}
+
+bool SpoolSink::deliver(const Notification& message, const string& text) {
+    string path = dir + "/" + idText(message.id) + ".eml";
+    error_code error;
+    if (filesystem::exists(path, error)) {
+        return true; // Sent before a restart
+    }
+    string temporary = path + ".tmp";
+    {
+        ofstream out(temporary.c_str(), ios::binary | ios::trunc);
+        if (!(out << text) || !out.flush()) {
+            return false;
+        }
+    }
+    filesystem::rename(temporary, path, error);
+    return !error;
+}
+
+NotificationOutbox::NotificationOutbox(const string& stateDir, unique_ptr<NotificationSink> sink)
+    : journalPath(stateDir + "/outbox.journal"), deliveredPath(stateDir + "/delivered.log"), sink(move(sink)),
+      stopping(false), deliveredSinceCompaction(0), queued(0), delivered(0), duplicates(0), retries(0) {
+    recover();
+    deliveredLog.open(deliveredPath.c_str(), ios::app);
+    compactJournal(); // Opens the journal
+    if (journal.is_open() && deliveredLog) {
+        worker = thread(&NotificationOutbox::run, this);
+    }
+}
+
+NotificationOutbox::~NotificationOutbox() {
+    stop();
+}
+
+// Queue whatever the last run journaled but never delivered.
+void NotificationOutbox::recover() {
+    unordered_set<uint64_t> sent;
+    ifstream deliveredIn(deliveredPath.c_str());
+    string line;
+    while (getline(deliveredIn, line)) {
+        sent.insert(strtoull(line.c_str(), nullptr, 16));
+    }
+
+    ifstream journalIn(journalPath.c_str());
+    while (getline(journalIn, line)) {
+        Notification message;
+        if (parseJournalLine(line, message) && sent.count(message.id) == 0 && known.insert(message.id).second) {
+            queue.push_back(message);
+            queued.fetch_add(1, memory_order_relaxed);
+        }
+    }
+}
+
+bool NotificationOutbox::enqueue(const Notification& message) {
+    {
+        lock_guard<mutex> lock(queueMutex);
+        if (!known.insert(message.id).second) {
+            duplicates.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        // On disk before the caller moves on, so a crash after a booking cannot lose its message
+        writeJournalLine(journal, message);
+        journal.flush();
+        queue.push_back(message);
+    }
+    queued.fetch_add(1, memory_order_relaxed);
+    wake.notify_one();
+    return true;
+}
+
+void NotificationOutbox::stop() {
+    if (!worker.joinable()) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+
+    // Leave the next run only what is still queued, or empty files if everything went out
+    lock_guard<mutex> lock(queueMutex);
+    compactJournal();
+}
+
+// Rewrite the journal to hold just the queued messages and swap it in with one rename, then empty
+// the delivered log, whose ids are no longer in the journal. If the rename fails both files stay
+// as they were. Called with the queue locked and no batch in flight.
+void NotificationOutbox::compactJournal() {
+    string tempPath = journalPath + ".tmp";
+    {
+        ofstream fresh(tempPath.c_str(), ios::trunc);
+        for (deque<Notification>::const_iterator it = queue.begin(); it != queue.end(); ++it) {
+            writeJournalLine(fresh, *it);
+        }
+        if (!fresh.flush()) {
+            fresh.close();
+            remove(tempPath.c_str());
+            if (!journal.is_open()) {
+                journal.open(journalPath.c_str(), ios::app);
+            }
+            return;
+        }
+    }
+    journal.close();
+    error_code error;
+    filesystem::rename(tempPath, journalPath, error);
+    journal.open(journalPath.c_str(), ios::app);
+    if (error) {
+        remove(tempPath.c_str());
+        return;
+    }
+    deliveredLog.close();
+    deliveredLog.open(deliveredPath.c_str(), ios::trunc);
+    deliveredSinceCompaction = 0;
+}
+
+void NotificationOutbox::run() {
+    unique_lock<mutex> lock(queueMutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return; // Stopping with nothing left to send
+        }
+
+        deque<Notification> batch;
+        while (!queue.empty() && batch.size() < BATCH_SIZE) {
+            batch.push_back(queue.front());
+            queue.pop_front();
+        }
+        vector<uint64_t> sent;
+        lock.unlock();
+        sendBatch(batch, sent);
+        lock.lock();
+        for (size_t i = 0; i < sent.size(); ++i) {
+            known.erase(sent[i]); // Delivered: the sink drops any later repeat
+        }
+        deliveredSinceCompaction += sent.size();
+
+        if (!batch.empty()) {
+            // The sink refused some messages: put them back and try again shortly
+            retries.fetch_add(batch.size(), memory_order_relaxed);
+            queue.insert(queue.begin(), batch.begin(), batch.end());
+        }
+        // Delivered messages stay in the journal until it is rewritten
+        if (deliveredSinceCompaction >= COMPACT_AFTER) {
+            compactJournal();
+        }
+
+        if (!batch.empty()) {
+            if (stopping) {
+                return; // Still in the journal for the next run
+            }
+            wake.wait_for(lock, chrono::seconds(1), [this]() { return stopping; });
+        }
+    }
+}
+
+// Send the batch, already journaled, and leave only the messages the sink refused in `batch`. The
+// ids delivered are added to `sent`.
+void NotificationOutbox::sendBatch(deque<Notification>& batch, vector<uint64_t>& sent) {
+    deque<Notification> refused;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (sink->deliver(batch[i], renderNotification(batch[i]))) {
+            deliveredLog << idText(batch[i].id) << '\n';
+            sent.push_back(batch[i].id);
+            delivered.fetch_add(1, memory_order_relaxed);
+        }
+        else {
+            refused.push_back(batch[i]);
+        }
+    }
+    deliveredLog.flush();
+    batch.swap(refused);
+}
+
+void NotificationOutbox::dumpStats(ostream& out) const {
+    size_t waiting;
+    {
+        lock_guard<mutex> lock(queueMutex);
+        waiting = queue.size();
+    }
+    out << "Queued: " << queued.load(memory_order_relaxed)
+        << ", delivered: " << delivered.load(memory_order_relaxed)
+        << ", waiting: " << waiting
+        << ", duplicates dropped: " << duplicates.load(memory_order_relaxed)
+        << ", retries: " << retries.load(memory_order_relaxed) << "\n";
+}
+
+uint64_t nextNotificationSequence() {
+    static atomic<uint64_t> sequence(static_cast<uint64_t>(
+        chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count()));
+    return sequence.fetch_add(1, memory_order_relaxed);
+}
+
+bool startNotificationOutbox(const string& dir) {
+    string mailDir = dir + "/mail";
+    error_code error;
+    filesystem::create_directories(mailDir, error);
+    if (error) {
+        return false;
+    }
+    unique_ptr<NotificationSink> sink(new SpoolSink(mailDir));
+    unique_ptr<NotificationOutbox> outbox(new NotificationOutbox(dir, move(sink)));
+    if (!outbox->isOpen()) {
+        return false;
+    }
+    lock_guard<mutex> lock(processOutboxMutex);
+    processOutbox = move(outbox);
+    return true;
+}
+
+void stopNotificationOutbox() {
+    lock_guard<mutex> lock(processOutboxMutex);
+    if (processOutbox) {
+        processOutbox->stop();
+    }
+}
+
+void queueNotification(const Notification& message) {
+    lock_guard<mutex> lock(processOutboxMutex);
+    if (processOutbox) {
+        processOutbox->enqueue(message);
+    }
+}
+
+void dumpNotificationStats(ostream& out) {
+    lock_guard<mutex> lock(processOutboxMutex);
+    if (processOutbox) {
+        processOutbox->dumpStats(out);
+    }
+    else {
+        out << "Notification outbox is not running.\n";
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+enum NotificationKind {
+    NOTIFY_CONFIRMATION,
+    NOTIFY_INVOICE,
+    NOTIFY_PAYMENT_DUE // A waitlisted booking was confirmed and still has to be paid
+};
+
+// A message waiting to be sent. Only the facts are queued; the text is rendered by the worker.
+struct Notification {
+    uint64_t id; // One id per send, kept through retries, so repeats of a send can be dropped
+    NotificationKind kind;
+    string email;
+    string name;
+    string eventDates; // Event date, or the comma separated dates on an invoice
+    double amount;     // Invoice total, or the amount due
+};
+
+// Text of the email for a notification.
+string renderNotification(const Notification& message);
+
+// Final hop of a notification, e.g. a mail server. Delivering the same id twice must be harmless.
+class NotificationSink {
+public:
+    virtual ~NotificationSink() {
+    }
+
+    virtual bool deliver(const Notification& message, const string& text) = 0;
+};
+
+// Stands in for the mail server: every message becomes <dir>/<id>.eml, written under a temporary
+// name and renamed into place, so a file that exists is complete. Existing files are not rewritten.
+class SpoolSink : public NotificationSink {
+public:
+    explicit SpoolSink(const string& dir) : dir(dir) {
+    }
+
+    bool deliver(const Notification& message, const string& text) override;
+
+private:
+    string dir;
+};
+
+// Notifications are queued in memory by the booking path and sent in batches by a background
+// worker, so booking latency never includes delivery time.
+//
+// Delivery is at-least-once: each message is appended to outbox.journal, once, before enqueue
+// returns, and the ids that reach the sink are appended to delivered.log. On start, journal
+// entries without a delivered id are sent again. An id still waiting to be delivered is dropped if
+// it is queued again; once delivered it is forgotten here, and the sink ignores ids it has seen,
+// so a message retried after a crash is not sent twice. Every COMPACT_AFTER deliveries, and on
+// start and stop, the journal is rewritten to hold only the queued messages and delivered.log is
+// emptied, so neither grows while the sink is down or the process runs for long.
+class NotificationOutbox {
+public:
+    static const size_t BATCH_SIZE = 64;
+    static const size_t COMPACT_AFTER = 1024;
+
+    NotificationOutbox(const string& stateDir, unique_ptr<NotificationSink> sink);
+    ~NotificationOutbox();
+
+    bool isOpen() const {
+        return journal.is_open();
+    }
+
+    // Journals the message and queues it, never waiting for delivery; returns false if the
+    // message is a duplicate.
+    bool enqueue(const Notification& message);
+
+    // Send everything still queued, then stop the worker.
+    void stop();
+
+    void dumpStats(ostream& out) const;
+
+private:
+    void recover();
+    void run();
+    void sendBatch(deque<Notification>& batch, vector<uint64_t>& sent);
+    void compactJournal();
+
+    string journalPath;
+    string deliveredPath;
+    unique_ptr<NotificationSink> sink;
+    ofstream journal;
+    ofstream deliveredLog;
+
+    mutable mutex queueMutex;
+    condition_variable wake;
+    deque<Notification> queue;
+    unordered_set<uint64_t> known; // Ids queued and not yet delivered
+    bool stopping;
+    size_t deliveredSinceCompaction;
+    thread worker;
+
+    atomic<uint64_t> queued;
+    atomic<uint64_t> delivered;
+    atomic<uint64_t> duplicates;
+    atomic<uint64_t> retries;
+};
+
+// Distinct on every call, in this run and across runs (it starts from the clock). Mixed into
+// notification ids so that sending the same message again is a new send, not a repeat.
+uint64_t nextNotificationSequence();
+
+// Process-wide outbox used by Event, spooling into `dir`. Until it is started, notifications are
+// dropped, which keeps replays and benchmarks free of mail traffic.
+bool startNotificationOutbox(const string& dir);
+void stopNotificationOutbox();
+void queueNotification(const Notification& message);
+void dumpNotificationStats(ostream& out);
@@ -0,0 +1,340 @@
+#include "pricing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+const char* const PACKAGE_NAMES[PACKAGE_COUNT] = { "Basic Package", "Classic Package", "Premium Package", "Luxury Package" };
+
+namespace {
+
+const char* const DEFAULT_RULES =
+    "tier = Basic, 0, 0.00\n"
+    "tier = Silver, 20, 0.05\n"
+    "tier = Gold, 50, 0.10\n"
+    "tier = Platinum, 100, 0.15\n"
+    "package = Basic Package, 30, 250\n"
+    "package = Classic Package, 50, 500\n"
+    "package = Premium Package, 100, 1000\n"
+    "package = Luxury Package, 0, 2500\n"
+    "addon = Photographer, 300\n"
+    "addon = Photobooth, 350\n"
+    "addon = Master of Event(MC), 450\n"
+    "advertisement = 200\n";
+
+const int MAX_THRESHOLD = 1000000; // Bounds the size of the tier table
+const int MAX_PACKAGE_GUESTS = 1000000;
+
+atomic<uint64_t> nextVersion(1);
+
+mutex rulesPathMutex;
+string rulesPath; // File named in the last loadPricing call
+
+string trim(const string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == string::npos) {
+        return "";
+    }
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+vector<string> splitFields(const string& text) {
+    vector<string> fields;
+    stringstream in(text);
+    string field;
+    while (getline(in, field, ',')) {
+        fields.push_back(trim(field));
+    }
+    return fields;
+}
+
+bool parseNumber(const string& text, double& value) {
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && isfinite(value) && value >= 0.0;
+}
+
+// A whole number from 0 to `limit`; fractions and anything out of range are refused, not cut.
+bool parseCount(const string& text, int limit, int& value) {
+    double number;
+    if (!parseNumber(text, number) || number != floor(number) || number > limit) {
+        return false;
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+shared_ptr<const PricingTable> builtInPricing() {
+    istringstream in(DEFAULT_RULES);
+    shared_ptr<PricingTable> table(new PricingTable());
+    string error;
+    compilePricing(in, *table, error);
+    table->source = "built-in";
+    return table;
+}
+
+// Swapped with atomic_load/atomic_store, so readers never wait for a reload. Declared before
+// pricingWatch so that it is destroyed after the watch thread that reloads it has stopped.
+shared_ptr<const PricingTable> activeTable = builtInPricing();
+
+class PricingWatch {
+public:
+    ~PricingWatch() {
+        stop();
+    }
+
+    bool start(const string& watchedPath, int intervalSeconds) {
+        stop();
+        error_code error;
+        lastWrite = filesystem::last_write_time(watchedPath, error);
+        if (error) {
+            return false;
+        }
+        path = watchedPath;
+        interval = intervalSeconds > 0 ? intervalSeconds : 2;
+        stopping = false;
+        worker = thread(&PricingWatch::run, this);
+        return true;
+    }
+
+    void stop() {
+        if (!worker.joinable()) {
+            return;
+        }
+        {
+            lock_guard<mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+private:
+    void run() {
+        unique_lock<mutex> lock(stateMutex);
+        while (!wake.wait_for(lock, chrono::seconds(interval), [this]() { return stopping; })) {
+            error_code error;
+            filesystem::file_time_type written = filesystem::last_write_time(path, error);
+            if (error || written == lastWrite) {
+                continue;
+            }
+            lastWrite = written;
+            string loadError;
+            loadPricing(path, loadError); // A broken edit leaves the previous rules in force
+        }
+    }
+
+    string path;
+    int interval;
+    filesystem::file_time_type lastWrite;
+    bool stopping;
+    thread worker;
+    mutex stateMutex;
+    condition_variable wake;
+};
+
+PricingWatch pricingWatch;
+
+}
+
+bool compilePricing(istream& in, PricingTable& table, string& error) {
+    int tiers = 0;
+    bool packageSeen[PACKAGE_COUNT] = { false };
+    bool feeSeen = false;
+    table.addonCount = 0;
+
+    string line;
+    int lineNumber = 0;
+    while (getline(in, line)) {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        ostringstream where;
+        where << "line " << lineNumber << ": ";
+
+        size_t equals = line.find('=');
+        if (equals == string::npos) {
+            error = where.str() + "expected <rule> = <values>";
+            return false;
+        }
+        string rule = trim(line.substr(0, equals));
+        vector<string> fields = splitFields(line.substr(equals + 1));
+        double first, second;
+        int count;
+
+        if (rule == "tier") {
+            if (fields.size() != 3 || !parseCount(fields[1], MAX_THRESHOLD, count) || !parseNumber(fields[2], second) || second > 1.0) {
+                error = where.str() + "expected tier = <name>, <minimum points up to " + to_string(MAX_THRESHOLD) + ">, <discount between 0 and 1>";
+                return false;
+            }
+            if (tiers == MEMBERSHIP_TIERS) {
+                error = where.str() + "too many tiers";
+                return false;
+            }
+            if ((tiers == 0 && count != 0) || (tiers > 0 && count <= table.tierThresholds[tiers - 1])) {
+                error = where.str() + "tier thresholds must start at 0 and increase";
+                return false;
+            }
+            table.tierNames[tiers] = fields[0];
+            table.tierThresholds[tiers] = count;
+            table.tierDiscounts[tiers] = second;
+            tiers++;
+        }
+        else if (rule == "package") {
+            int index = 0;
+            while (index < PACKAGE_COUNT && (fields.empty() || fields[0] != PACKAGE_NAMES[index])) {
+                index++;
+            }
+            if (fields.size() != 3 || index == PACKAGE_COUNT || !parseCount(fields[1], MAX_PACKAGE_GUESTS, count) || !parseNumber(fields[2], second)) {
+                error = where.str() + "expected package = <package name>, <maximum guests up to " + to_string(MAX_PACKAGE_GUESTS) + ">, <price>";
+                return false;
+            }
+            table.packageGuests[index] = count;
+            table.packagePrices[index] = second;
+            packageSeen[index] = true;
+        }
+        else if (rule == "addon") {
+            if (fields.size() != 2 || fields[0].empty() || !parseNumber(fields[1], first)) {
+                error = where.str() + "expected addon = <name>, <price>";
+                return false;
+            }
+            if (table.addonCount == MAX_ADDONS) {
+                error = where.str() + "too many add-ons";
+                return false;
+            }
+            table.addonNames[table.addonCount] = fields[0];
+            table.addonPrices[table.addonCount] = first;
+            table.addonCount++;
+        }
+        else if (rule == "advertisement") {
+            if (fields.size() != 1 || !parseNumber(fields[0], first)) {
+                error = where.str() + "expected advertisement = <fee>";
+                return false;
+            }
+            table.advertisementFee = first;
+            feeSeen = true;
+        }
+        else {
+            error = where.str() + "unknown rule \"" + rule + "\"";
+            return false;
+        }
+    }
+
+    if (tiers != MEMBERSHIP_TIERS) {
+        error = "expected four membership tiers";
+        return false;
+    }
+    for (int p = 0; p < PACKAGE_COUNT; ++p) {
+        if (!packageSeen[p]) {
+            error = string("missing package ") + PACKAGE_NAMES[p];
+            return false;
+        }
+    }
+    if (!feeSeen) {
+        error = "missing advertisement fee";
+        return false;
+    }
+
+    // Compile the tier table: one entry per balance up to the top threshold
+    table.rankByPoints.assign(table.tierThresholds[MEMBERSHIP_TIERS - 1] + 1, 0);
+    for (int rank = 1; rank < MEMBERSHIP_TIERS; ++rank) {
+        fill(table.rankByPoints.begin() + table.tierThresholds[rank], table.rankByPoints.end(), static_cast<uint8_t>(rank));
+    }
+    table.version = nextVersion.fetch_add(1);
+    return true;
+}
+
+shared_ptr<const PricingTable> currentPricing() {
+    return atomic_load(&activeTable);
+}
+
+bool loadPricing(const string& path, string& error) {
+    {
+        lock_guard<mutex> lock(rulesPathMutex);
+        rulesPath = path;
+    }
+    ifstream in(path.c_str());
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    shared_ptr<PricingTable> table(new PricingTable());
+    if (!compilePricing(in, *table, error)) {
+        error = path + ", " + error;
+        return false;
+    }
+    table->source = path;
+    atomic_store(&activeTable, shared_ptr<const PricingTable>(table));
+    return true;
+}
+
+bool reloadPricing(string& error) {
+    string path;
+    {
+        lock_guard<mutex> lock(rulesPathMutex);
+        path = rulesPath;
+    }
+    if (path.empty()) {
+        error = "no pricing file has been loaded";
+        return false;
+    }
+    return loadPricing(path, error);
+}
+
+void dumpPricing(ostream& out) {
+    shared_ptr<const PricingTable> pricing = currentPricing();
+    out << "Source: " << pricing->source << " (version " << pricing->version << ")\n";
+    out << "----------------------------------------\n";
+    for (int rank = 0; rank < MEMBERSHIP_TIERS; ++rank) {
+        out << "Tier " << pricing->tierNames[rank] << ": from " << pricing->tierThresholds[rank] << " points, "
+            << pricing->tierDiscounts[rank] * 100 << "% discount\n";
+    }
+    for (int p = 0; p < PACKAGE_COUNT; ++p) {
+        out << PACKAGE_NAMES[p] << ": " << formatPrice(pricing->packagePrices[p]) << ", ";
+        if (pricing->packageGuests[p] > 0) {
+            out << "up to " << pricing->packageGuests[p] << " guests\n";
+        }
+        else {
+            out << "up to the event limit\n";
+        }
+    }
+    for (int a = 0; a < pricing->addonCount; ++a) {
+        out << "Add-on " << pricing->addonNames[a] << ": " << formatPrice(pricing->addonPrices[a]) << "\n";
+    }
+    out << "Advertisement: " << formatPrice(pricing->advertisementFee) << "\n";
+    out << "----------------------------------------\n";
+}
+
+bool startPricingWatch(const string& path, int intervalSeconds) {
+    return pricingWatch.start(path, intervalSeconds);
+}
+
+void stopPricingWatch() {
+    pricingWatch.stop();
+}
+
+string membershipLevel(int loyaltyPoints) {
+    shared_ptr<const PricingTable> pricing = currentPricing();
+    return pricing->tierNames[pricing->rank(loyaltyPoints)];
+}
+
+int membershipRank(int loyaltyPoints) {
+    return currentPricing()->rank(loyaltyPoints);
+}
+
+string formatPrice(double price) {
+    ostringstream text;
+    text << "RM" << fixed << setprecision(2) << price;
+    return text.str();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const int MEMBERSHIP_TIERS = 4;
+const int PACKAGE_COUNT = 4;
+const int MAX_ADDONS = 8;
+
+// Package names, in menu order. Prices and guest limits come from the pricing rules.
+extern const char* const PACKAGE_NAMES[PACKAGE_COUNT];
+
+// Pricing rules compiled into flat arrays. Membership tiers are resolved through a table with
+// one entry per point balance up to the top threshold, so a quote never walks the rules.
+// Tables are immutable once built; a reload builds a new one and swaps it in.
+struct PricingTable {
+    uint64_t version;
+    string source; // File the rules came from, or "built-in"
+
+    string tierNames[MEMBERSHIP_TIERS]; // Lowest tier first
+    int tierThresholds[MEMBERSHIP_TIERS];
+    double tierDiscounts[MEMBERSHIP_TIERS];
+    vector<uint8_t> rankByPoints; // Balances past the end share the top tier
+
+    double packagePrices[PACKAGE_COUNT];
+    int packageGuests[PACKAGE_COUNT]; // 0: up to the event's guest limit
+
+    int addonCount;
+    string addonNames[MAX_ADDONS];
+    double addonPrices[MAX_ADDONS];
+
+    double advertisementFee;
+
+    int rank(int loyaltyPoints) const {
+        size_t index = static_cast<size_t>(max(loyaltyPoints, 0));
+        return rankByPoints[min(index, rankByPoints.size() - 1)];
+    }
+};
+
+// Read pricing rules. The format is one rule per line, '#' starts a comment:
+//
+//   tier = <name>, <minimum points>, <discount>        four lines, lowest tier first
+//   package = <name>, <maximum guests>, <price>        one line per package
+//   addon = <name>, <price>                            up to MAX_ADDONS lines, in menu order
+//   advertisement = <fee>
+//
+// Returns false, with a message naming the line, if the rules are incomplete or inconsistent.
+bool compilePricing(istream& in, PricingTable& table, string& error);
+
+// Rules currently in force; the built-in defaults until a file is loaded. Safe from any thread.
+shared_ptr<const PricingTable> currentPricing();
+
+// Compile `path` and swap it in atomically. Quotes already in progress keep the table they
+// started with. On failure the current rules stay in force.
+bool loadPricing(const string& path, string& error);
+
+// Load the file named in the last loadPricing call again, e.g. after it was edited.
+bool reloadPricing(string& error);
+
+// Print the rules in force.
+void dumpPricing(ostream& out);
+
+// Reload `path` from a background thread whenever its modification time changes.
+bool startPricingWatch(const string& path, int intervalSeconds);
+void stopPricingWatch();
+
+// Membership level earned by a number of loyalty points under the current rules.
+string membershipLevel(int loyaltyPoints);
+
+// Membership level as a number (Basic = 0 ... Platinum = 3) for ordering waitlists.
+int membershipRank(int loyaltyPoints);
+
+// A price as shown on menus, always with two decimals, e.g. "RM250.00".
+string formatPrice(double price);
@@ -0,0 +1,367 @@
+#include "profile_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+const uint64_t COMPACT_MIN_GARBAGE = 1 << 20; // Rewrite the file once this much of it is stale
+
+// Heap bytes behind a string; short strings live inside the object.
+size_t heapBytes(const string& text) {
+    const char* data = text.data();
+    const char* object = reinterpret_cast<const char*>(&text);
+    return data >= object && data < object + sizeof(text) ? 0 : text.capacity() + 1;
+}
+
+size_t profileBytes(const string& key, const User& user) {
+    size_t bytes = sizeof(User) + sizeof(key) + heapBytes(key) + 64; // 64: list and index nodes
+    bytes += heapBytes(user.name) + heapBytes(user.email) + heapBytes(user.contact) + heapBytes(user.eventDate) + heapBytes(user.packageType);
+    for (int i = 0; i < MAX_EVENTS; ++i) {
+        bytes += heapBytes(user.pastEvents[i]) + heapBytes(user.pastEventPackages[i]);
+    }
+    for (int i = 0; i < MAX_INTERACTIONS; ++i) {
+        bytes += heapBytes(user.interactions[i]);
+    }
+    return bytes;
+}
+
+void putNumber(string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void putText(string& out, const string& text) {
+    putNumber(out, text.size());
+    out += text;
+}
+
+bool getNumber(const string& in, size_t& at, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && at < in.size(); shift += 7) {
+        unsigned char c = static_cast<unsigned char>(in[at++]);
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getText(const string& in, size_t& at, string& text) {
+    uint64_t length;
+    if (!getNumber(in, at, length) || length > in.size() - at) {
+        return false;
+    }
+    text.assign(in, at, static_cast<size_t>(length));
+    at += static_cast<size_t>(length);
+    return true;
+}
+
+// Varint lengths and counts followed by the bytes; loyalty points are zigzag encoded.
+string encodeProfile(const User& user) {
+    string out;
+    putText(out, user.name);
+    putText(out, user.email);
+    putText(out, user.contact);
+    putText(out, user.eventDate);
+    putText(out, user.packageType);
+    putNumber(out, static_cast<uint64_t>(max(user.numGuests, 0)));
+    putNumber(out, user.isMember ? 1 : 0);
+    int64_t points = user.loyaltyPoints;
+    putNumber(out, (static_cast<uint64_t>(points) << 1) ^ static_cast<uint64_t>(points >> 63));
+    putNumber(out, static_cast<uint64_t>(user.pastEventCount));
+    for (int i = 0; i < user.pastEventCount; ++i) {
+        putText(out, user.pastEvents[i]);
+        putText(out, user.pastEventPackages[i]);
+    }
+    putNumber(out, static_cast<uint64_t>(user.interactionCount));
+    for (int i = 0; i < user.interactionCount; ++i) {
+        putText(out, user.interactions[i]);
+    }
+    return out;
+}
+
+bool decodeProfile(const string& in, User& user) {
+    size_t at = 0;
+    uint64_t guests, member, points, events, interactions;
+    if (!getText(in, at, user.name) || !getText(in, at, user.email) || !getText(in, at, user.contact) ||
+        !getText(in, at, user.eventDate) || !getText(in, at, user.packageType) ||
+        !getNumber(in, at, guests) || !getNumber(in, at, member) || !getNumber(in, at, points) ||
+        !getNumber(in, at, events) || events > MAX_EVENTS) {
+        return false;
+    }
+    user.numGuests = static_cast<int>(guests);
+    user.isMember = member != 0;
+    user.loyaltyPoints = static_cast<int>(static_cast<int64_t>(points >> 1) ^ -static_cast<int64_t>(points & 1));
+    user.pastEventCount = static_cast<int>(events);
+    for (int i = 0; i < user.pastEventCount; ++i) {
+        if (!getText(in, at, user.pastEvents[i]) || !getText(in, at, user.pastEventPackages[i])) {
+            return false;
+        }
+    }
+    if (!getNumber(in, at, interactions) || interactions > MAX_INTERACTIONS) {
+        return false;
+    }
+    user.interactionCount = static_cast<int>(interactions);
+    for (int i = 0; i < user.interactionCount; ++i) {
+        if (!getText(in, at, user.interactions[i])) {
+            return false;
+        }
+    }
+    return at == in.size();
+}
+
+// Create a spill file no other store uses: `base` with this process id, and a counter after it
+// if that name is taken, say by a file left behind by a crashed run. Returns the name, or "".
+string createSpillFile(const string& base) {
+#ifdef _WIN32
+    string prefix = base + "." + to_string(_getpid());
+#else
+    string prefix = base + "." + to_string(getpid());
+#endif
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        string path = attempt == 0 ? prefix : prefix + "-" + to_string(attempt);
+        FILE* created = fopen(path.c_str(), "wbx"); // Fails if the file already exists
+        if (created) {
+            fclose(created);
+            return path;
+        }
+        if (errno != EEXIST) {
+            break;
+        }
+    }
+    return "";
+}
+
+// Move `from` over `to` in one step, so `to` is always either the old file or the new one.
+bool replaceFile(const string& from, const string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+mutex processStoreMutex;
+unique_ptr<ProfileStore> processStore;
+
+}
+
+ProfileStore::ProfileStore(const string& spillBase, size_t memoryLimit)
+    : coldPath(createSpillFile(spillBase)), memoryLimit(memoryLimit), hotBytes(0), coldEnd(0), coldGarbage(0),
+      hits(0), coldLoads(0), newProfiles(0), evictions(0), coldWrites(0), compactions(0) {
+    if (!coldPath.empty()) {
+        cold.open(coldPath.c_str(), ios::in | ios::out | ios::binary);
+    }
+}
+
+ProfileStore::~ProfileStore() {
+    if (cold.is_open()) {
+        cold.close();
+        remove(coldPath.c_str());
+    }
+}
+
+bool ProfileStore::load(const string& email, User& user) {
+    string key = customerKey(email);
+    lock_guard<mutex> lock(storeMutex);
+    unordered_map<string, HotEntry>::iterator found = hotIndex.find(key);
+    if (found != hotIndex.end()) {
+        hot.splice(hot.begin(), hot, found->second);
+        user = found->second->profile;
+        hits++;
+        return true;
+    }
+
+    unordered_map<string, ColdProfile>::const_iterator stored = coldIndex.find(key);
+    string record;
+    HotProfile loaded;
+    if (stored == coldIndex.end() || !readCold(stored->second, record) || !decodeProfile(record, loaded.profile)) {
+        newProfiles++;
+        return false;
+    }
+    coldLoads++;
+    user = loaded.profile;
+
+    // The file keeps its copy, so the profile can be dropped again without a write until it changes
+    loaded.key = key;
+    loaded.bytes = profileBytes(key, loaded.profile);
+    loaded.dirty = false;
+    hot.push_front(move(loaded));
+    hotIndex[key] = hot.begin();
+    hotBytes += hot.front().bytes;
+    evict();
+    return true;
+}
+
+void ProfileStore::save(const User& user) {
+    if (user.email.empty()) {
+        return;
+    }
+    string key = customerKey(user.email);
+    lock_guard<mutex> lock(storeMutex);
+    unordered_map<string, HotEntry>::iterator found = hotIndex.find(key);
+    if (found == hotIndex.end()) {
+        HotProfile fresh;
+        fresh.key = key;
+        fresh.bytes = 0;
+        hot.push_front(move(fresh));
+        found = hotIndex.insert(make_pair(key, hot.begin())).first;
+    }
+    else {
+        hot.splice(hot.begin(), hot, found->second);
+    }
+    HotProfile& entry = *found->second;
+    entry.profile = user;
+    hotBytes -= entry.bytes;
+    entry.bytes = profileBytes(key, entry.profile);
+    hotBytes += entry.bytes;
+    entry.dirty = true;
+    evict();
+}
+
+// Drop least recently used profiles until the hot set fits, always keeping the newest one.
+void ProfileStore::evict() {
+    while (hotBytes > memoryLimit && hot.size() > 1) {
+        HotProfile& victim = hot.back();
+        if (victim.dirty || coldIndex.find(victim.key) == coldIndex.end()) {
+            writeCold(victim.key, victim.profile);
+        }
+        hotBytes -= victim.bytes;
+        hotIndex.erase(victim.key);
+        hot.pop_back();
+        evictions++;
+    }
+    if (coldGarbage >= COMPACT_MIN_GARBAGE && coldGarbage > coldEnd / 2) {
+        compact();
+    }
+}
+
+bool ProfileStore::readCold(const ColdProfile& where, string& record) {
+    record.resize(where.length);
+    cold.clear();
+    cold.seekg(static_cast<streamoff>(where.offset));
+    cold.read(&record[0], where.length);
+    return cold.gcount() == static_cast<streamsize>(where.length);
+}
+
+void ProfileStore::writeCold(const string& key, const User& profile) {
+    string record = encodeProfile(profile);
+    cold.clear();
+    cold.seekp(static_cast<streamoff>(coldEnd));
+    cold.write(record.data(), record.size());
+    if (!cold) {
+        return; // The profile is lost from the file, as from a full disk; the customer starts afresh
+    }
+    unordered_map<string, ColdProfile>::iterator previous = coldIndex.find(key);
+    if (previous != coldIndex.end()) {
+        coldGarbage += previous->second.length;
+    }
+    ColdProfile where = { coldEnd, static_cast<uint32_t>(record.size()) };
+    coldIndex[key] = where;
+    coldEnd += record.size();
+    coldWrites++;
+}
+
+// Copy the current records into a fresh file and swap it in.
+void ProfileStore::compact() {
+    string tempPath = coldPath + ".tmp";
+    fstream fresh(tempPath.c_str(), ios::in | ios::out | ios::binary | ios::trunc);
+    if (!fresh) {
+        return;
+    }
+    unordered_map<string, ColdProfile> freshIndex;
+    uint64_t freshEnd = 0;
+    string record;
+    for (unordered_map<string, ColdProfile>::const_iterator it = coldIndex.begin(); it != coldIndex.end(); ++it) {
+        if (!readCold(it->second, record)) {
+            continue;
+        }
+        fresh.write(record.data(), record.size());
+        ColdProfile where = { freshEnd, it->second.length };
+        freshIndex[it->first] = where;
+        freshEnd += record.size();
+    }
+    fresh.close();
+    if (!fresh) {
+        remove(tempPath.c_str());
+        return;
+    }
+    // The old file and index stay in use until the new file has taken its place
+    cold.close();
+    bool replaced = replaceFile(tempPath, coldPath);
+    cold.open(coldPath.c_str(), ios::in | ios::out | ios::binary);
+    if (!replaced) {
+        remove(tempPath.c_str());
+        return;
+    }
+    coldIndex.swap(freshIndex);
+    coldEnd = freshEnd;
+    coldGarbage = 0;
+    compactions++;
+}
+
+void ProfileStore::dumpStats(ostream& out) const {
+    lock_guard<mutex> lock(storeMutex);
+    uint64_t lookups = hits + coldLoads + newProfiles;
+    out << "Hot: " << hot.size() << " profiles, " << hotBytes / 1024 << " of " << memoryLimit / 1024 << " KB"
+        << ", on disk: " << coldIndex.size() << " profiles, " << coldEnd / 1024 << " KB\n";
+    out << "Hits: " << hits << ", misses: " << coldLoads + newProfiles << " (" << coldLoads << " read from disk, "
+        << newProfiles << " new customers)";
+    if (lookups > 0) {
+        out << ", hit rate: " << fixed << setprecision(1) << 100.0 * hits / lookups << "%";
+    }
+    out << "\nEvictions: " << evictions << ", disk writes: " << coldWrites << ", compactions: " << compactions << "\n";
+}
+
+bool startProfileStore(const string& spillBase, size_t memoryLimit) {
+    unique_ptr<ProfileStore> store(new ProfileStore(spillBase, memoryLimit));
+    if (!store->isOpen()) {
+        return false;
+    }
+    lock_guard<mutex> lock(processStoreMutex);
+    processStore = move(store);
+    return true;
+}
+
+void stopProfileStore() {
+    lock_guard<mutex> lock(processStoreMutex);
+    processStore.reset();
+}
+
+bool loadProfile(const string& email, User& user) {
+    lock_guard<mutex> lock(processStoreMutex);
+    return processStore && processStore->load(email, user);
+}
+
+void saveProfile(const User& user) {
+    lock_guard<mutex> lock(processStoreMutex);
+    if (processStore) {
+        processStore->save(user);
+    }
+}
+
+void dumpProfileStats(ostream& out) {
+    lock_guard<mutex> lock(processStoreMutex);
+    if (processStore) {
+        processStore->dumpStats(out);
+    }
+    else {
+        out << "Profile store is not running.\n";
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "event.h"
+
+using namespace std;
+
+// Customer profiles, history included, in two tiers. The most recently used profiles are kept
+// in memory as User records, up to a byte budget; the rest are evicted to a file in a compact
+// binary form and brought back on login with one read. The file is a spill area for this store
+// alone: it is created next to `spillBase` under a name with the process id, so other runs
+// sharing the base name never touch it, and it is removed when the store closes.
+class ProfileStore {
+public:
+    ProfileStore(const string& spillBase, size_t memoryLimit);
+    ~ProfileStore();
+
+    bool isOpen() const {
+        return cold.is_open();
+    }
+
+    // Copy the profile for `email` into `user`; false if the customer has no profile yet.
+    bool load(const string& email, User& user);
+
+    // Keep `user`'s profile, replacing any earlier copy. Profiles without an email are ignored.
+    void save(const User& user);
+
+    void dumpStats(ostream& out) const;
+
+private:
+    struct HotProfile {
+        string key;
+        User profile;
+        size_t bytes;
+        bool dirty; // Changed since it was last written to the file
+    };
+
+    struct ColdProfile {
+        uint64_t offset;
+        uint32_t length;
+    };
+
+    typedef list<HotProfile>::iterator HotEntry;
+
+    void evict();
+    bool readCold(const ColdProfile& where, string& record);
+    void writeCold(const string& key, const User& profile);
+    void compact();
+
+    string coldPath;
+    size_t memoryLimit;
+    mutable mutex storeMutex;
+
+    list<HotProfile> hot; // Most recently used first
+    unordered_map<string, HotEntry> hotIndex;
+    size_t hotBytes;
+
+    fstream cold;
+    unordered_map<string, ColdProfile> coldIndex;
+    uint64_t coldEnd;
+    uint64_t coldGarbage; // Bytes of records that have since been rewritten
+
+    uint64_t hits;
+    uint64_t coldLoads;
+    uint64_t newProfiles;
+    uint64_t evictions;
+    uint64_t coldWrites;
+    uint64_t compactions;
+};
+
+// Process-wide profile store used at login. Until it is started, profiles are not kept between
+// logins and every customer starts with an empty history.
+bool startProfileStore(const string& spillBase, size_t memoryLimit);
+void stopProfileStore();
+bool loadProfile(const string& email, User& user);
+void saveProfile(const User& user);
+void dumpProfileStats(ostream& out);
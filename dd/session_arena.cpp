@@ -0,0 +1,32 @@
+#include "session_arena.h"
+
+namespace {
+
+thread_local SessionArena* currentArena = nullptr;
+thread_local unique_ptr<char[]> spareBlock; // Block of the last arena, for the next session
+
+unique_ptr<char[]> takeBlock() {
+    if (spareBlock) {
+        return move(spareBlock);
+    }
+    return unique_ptr<char[]>(new char[SessionArena::BLOCK_SIZE]);
+}
+
+}
+
+SessionArena::SessionArena()
+    : block(takeBlock()), memory(block.get(), BLOCK_SIZE, pmr::new_delete_resource()), previous(currentArena) {
+    currentArena = this;
+}
+
+SessionArena::~SessionArena() {
+    currentArena = previous;
+    memory.release();
+    if (!spareBlock) {
+        spareBlock = move(block);
+    }
+}
+
+pmr::memory_resource* sessionMemory() {
+    return currentArena ? currentArena->resource() : pmr::get_default_resource();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Scratch memory for one console session. Strings and tables that only live for one menu action
+// (answers to prompts, rendered lines, search terms) are carved out of a block that is kept from
+// session to session and dropped all at once when the action ends, so a booking does not go to
+// the global heap for each of them. An action that outgrows the block borrows from the heap until
+// the next reset.
+class SessionArena {
+public:
+    static const size_t BLOCK_SIZE = 16 * 1024;
+
+    // The arena serves sessionMemory() on this thread until it is destroyed.
+    SessionArena();
+    ~SessionArena();
+
+    SessionArena(const SessionArena&) = delete;
+    SessionArena& operator=(const SessionArena&) = delete;
+
+    // Free everything allocated since the last reset. Nothing taken from the arena may outlive it.
+    void reset() {
+        memory.release();
+    }
+
+    pmr::memory_resource* resource() {
+        return &memory;
+    }
+
+private:
+    unique_ptr<char[]> block;
+    pmr::monotonic_buffer_resource memory;
+    SessionArena* previous;
+};
+
+// Memory for temporaries of the current session: the innermost SessionArena on this thread, or
+// the global heap outside a session.
+pmr::memory_resource* sessionMemory();
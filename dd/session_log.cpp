@@ -0,0 +1,168 @@
+#include "session_log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+const char MAGIC[4] = { 'D', 'D', 'S', 'R' };
+const char VERSION = 0x01;
+const char SESSION_TAG = 0x01;
+const char LINE_TAG = 0x02;
+
+bool readHeader(ifstream& in) {
+    char header[sizeof(MAGIC) + 1];
+    return in.read(header, sizeof(header)) && memcmp(header, MAGIC, sizeof(MAGIC)) == 0 && header[sizeof(MAGIC)] == VERSION;
+}
+
+void writeVarint(ofstream& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+bool readVarint(ifstream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == EOF) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+SessionRecorder::SessionRecorder(const string& path) : last(chrono::steady_clock::now()) {
+    // Never append to something that is not a recording of this version
+    bool fresh;
+    {
+        ifstream existing(path.c_str(), ios::binary);
+        fresh = !existing || existing.peek() == EOF;
+        if (!fresh && !readHeader(existing)) {
+            return;
+        }
+    }
+    out.open(path.c_str(), ios::binary | ios::app);
+    if (out) {
+        if (fresh) {
+            out.write(MAGIC, sizeof(MAGIC));
+            out.put(VERSION);
+        }
+        int64_t startMs = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        out.put(SESSION_TAG);
+        writeVarint(out, static_cast<uint64_t>(startMs));
+        out.flush();
+    }
+}
+
+void SessionRecorder::onLine(string_view line) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (out) {
+        out.put(LINE_TAG);
+        writeVarint(out, static_cast<uint64_t>(chrono::duration_cast<chrono::milliseconds>(now - last).count()));
+        writeVarint(out, line.size());
+        out.write(line.data(), line.size());
+        out.flush(); // Keep the recording intact even if the session is killed
+    }
+    last = now;
+}
+
+ReplaySource::ReplaySource(const RecordedSession& session, bool paced) : session(session), paced(paced), next(0), pendingOffset(0) {
+}
+
+size_t ReplaySource::read(char* buffer, size_t capacity) {
+    size_t filled = 0;
+    while (filled < capacity) {
+        if (pendingOffset == pending.size()) {
+            // Paced replays hand over one line per read, after the recorded delay
+            if (next >= session.lines.size() || (paced && filled > 0)) {
+                break;
+            }
+            const RecordedLine& recorded = session.lines[next++];
+            if (paced && recorded.delayMs > 0) {
+                this_thread::sleep_for(chrono::milliseconds(recorded.delayMs));
+            }
+            pending.assign(recorded.text);
+            pending += '\n';
+            pendingOffset = 0;
+        }
+        size_t count = min(capacity - filled, pending.size() - pendingOffset);
+        memcpy(buffer + filled, pending.data() + pendingOffset, count);
+        filled += count;
+        pendingOffset += count;
+    }
+    return filled;
+}
+
+bool loadSessions(const string& path, vector<RecordedSession>& sessions, string& error) {
+    ifstream in(path.c_str(), ios::binary | ios::ate);
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+    const streamoff fileSize = in.tellg();
+    in.seekg(0);
+    if (!readHeader(in)) {
+        error = path + " is not a session recording of this version";
+        return false;
+    }
+
+    bool inSession = false; // Lines belong to the last session opened in this file
+    const char* problem = nullptr;
+    streamoff record = in.tellg();
+    int tag;
+    while ((tag = in.get()) != EOF) {
+        uint64_t value, length;
+        if (tag == SESSION_TAG) {
+            if (!readVarint(in, value)) {
+                problem = "truncated session start";
+                break;
+            }
+            RecordedSession session;
+            session.startMs = static_cast<int64_t>(value);
+            sessions.push_back(session);
+            inSession = true;
+        }
+        else if (tag != LINE_TAG) {
+            problem = "unknown record";
+            break;
+        }
+        else if (!inSession) {
+            problem = "input line before any session";
+            break;
+        }
+        else if (!readVarint(in, value) || !readVarint(in, length)) {
+            problem = "truncated input line";
+            break;
+        }
+        else {
+            // A corrupt length must not size the buffer: no line is longer than the rest of the file
+            const streamoff position = in.tellg();
+            if (position < 0 || length > static_cast<uint64_t>(fileSize - position)) {
+                problem = "input line longer than the rest of the file";
+                break;
+            }
+            RecordedLine recorded;
+            recorded.delayMs = static_cast<uint32_t>(value);
+            recorded.text.resize(static_cast<size_t>(length));
+            in.read(&recorded.text[0], static_cast<streamsize>(length));
+            sessions.back().lines.push_back(recorded);
+        }
+        record = in.tellg();
+    }
+
+    if (problem) {
+        error = path + ": decoding stopped at byte " + to_string(record) + ", " + problem;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "input_reader.h"
+
+using namespace std;
+
+// Discards everything written to it, so console code can run without a terminal.
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    streamsize xsputn(const char*, streamsize n) override {
+        return n;
+    }
+};
+
+// One line of console input and how long after the previous line it arrived.
+struct RecordedLine {
+    uint32_t delayMs;
+    string text;
+};
+
+struct RecordedSession {
+    int64_t startMs; // Wall-clock start, milliseconds since the epoch
+    vector<RecordedLine> lines;
+};
+
+// Receives every line the console reads and appends it, with its arrival time, to a session
+// recording. Recordings are appended, so one file can collect every session of a day.
+//
+// File layout: the bytes "DDSR" and a version byte, 0x01, start the file. A 0x01 byte and a
+// varint start time open each session; every input line is a 0x02 byte, a varint delay in
+// milliseconds, a varint length and the line without its newline. An existing file is only
+// appended to if it starts with that header.
+class SessionRecorder : public LineObserver {
+public:
+    explicit SessionRecorder(const string& path);
+
+    bool isOpen() const {
+        return out.is_open();
+    }
+
+    void onLine(string_view line) override;
+
+private:
+    ofstream out;
+    chrono::steady_clock::time_point last;
+};
+
+// Input source that feeds a recorded session back, either as fast as the reader takes it or one
+// line at a time at the original pacing.
+class ReplaySource : public InputSource {
+public:
+    ReplaySource(const RecordedSession& session, bool paced);
+
+    size_t read(char* buffer, size_t capacity) override;
+
+private:
+    const RecordedSession& session;
+    bool paced;
+    size_t next;
+    string pending; // Part of a line that did not fit in the last read
+    size_t pendingOffset;
+};
+
+// Append every session stored in `path` to `sessions`. Returns false with `error` set if the file
+// cannot be read, is not a recording, or stops decoding part way; the error then gives the byte
+// offset where decoding stopped, and the sessions read before it are still appended.
+bool loadSessions(const string& path, vector<RecordedSession>& sessions, string& error);
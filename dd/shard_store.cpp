@@ -0,0 +1,738 @@
+#include "shard_store.h"
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const int EMPTY_DAY = INT_MIN;
+const int COPY_BATCH = 8; // Records handed back per read request
+const int RETRIES = 3;    // Attempts at a request that is safe to repeat
+
+// Stores before a commit point are in the segment before the ones after it. A killed worker loses
+// none of the stores it made, so only the compiler's ordering needs pinning down.
+void commit() {
+    atomic_signal_fence(memory_order_seq_cst);
+}
+
+int crashCountdown = 0; // Worker only: checkpoints left before a simulated crash, 0 if not armed
+
+// Where a worker armed by ShardedStore::crashShardAt may die.
+void crashCheckpoint() {
+    if (crashCountdown > 0 && --crashCountdown == 0) {
+        _exit(1);
+    }
+}
+
+// Fixed-size copy of a Registration; longer names are truncated.
+struct ShardRecord {
+    char userName[48];
+    char email[64];
+    char packageType[24];
+    int day;
+    int numGuests;
+    double packagePrice;
+    double advertisementPrice;
+    int nextOnDay; // Next record on the same day's chain, -1 at the end
+    uint32_t moveToken; // Move that copied the record here, 0 for a booking
+    int8_t package; // Index into PACKAGE_NAMES, -1 for anything else
+    uint8_t isMember;
+    uint8_t live;   // Cleared when the record moves to another shard
+};
+
+struct DaySlot {
+    int day; // EMPTY_DAY if unused
+    int firstRecord;
+    uint32_t moveToken; // Move from another shard that claimed the day, 0 if none
+    uint8_t booked;
+};
+
+// A move within the shard, recorded before it changes anything, so that one cut short by a dead
+// worker can be finished before the replacement starts.
+struct MoveIntent {
+    int active;
+    int fromDay;
+    int toDay;
+    int fromHead; // Chains as they were before the move
+    int fromTail;
+    int toHead;
+};
+
+struct SegmentHeader {
+    int recordCapacity;
+    int slotCount; // Power of two
+    int usedSlots;
+    int recordCount;
+    MoveIntent move;
+};
+
+// Layout of a segment: the header, the open-addressed day table, then the records in booking order.
+class Segment {
+public:
+    static size_t slotsFor(int capacity) {
+        size_t slots = 16;
+        while (slots < static_cast<size_t>(capacity) * 2) {
+            slots *= 2;
+        }
+        return slots;
+    }
+
+    static size_t bytesFor(int capacity) {
+        return sizeof(SegmentHeader) + slotsFor(capacity) * sizeof(DaySlot) + static_cast<size_t>(capacity) * sizeof(ShardRecord);
+    }
+
+    explicit Segment(void* base)
+        : header(static_cast<SegmentHeader*>(base)),
+          slots(reinterpret_cast<DaySlot*>(header + 1)),
+          records(reinterpret_cast<ShardRecord*>(slots + header->slotCount)) {
+    }
+
+    static void format(void* base, int capacity) {
+        SegmentHeader* header = static_cast<SegmentHeader*>(base);
+        header->recordCapacity = capacity;
+        header->slotCount = static_cast<int>(slotsFor(capacity));
+        header->usedSlots = 0;
+        header->recordCount = 0;
+        header->move.active = 0;
+        DaySlot* slots = reinterpret_cast<DaySlot*>(header + 1);
+        for (int i = 0; i < header->slotCount; ++i) {
+            slots[i].day = EMPTY_DAY;
+            slots[i].firstRecord = -1;
+            slots[i].moveToken = 0;
+            slots[i].booked = 0;
+        }
+    }
+
+    // Slot for `day`; with `insert`, a new one is taken unless the table is three quarters full.
+    DaySlot* find(int day, bool insert) const {
+        int mask = header->slotCount - 1;
+        int index = static_cast<int>((static_cast<uint32_t>(day) * 2654435761u) & mask);
+        while (slots[index].day != EMPTY_DAY) {
+            if (slots[index].day == day) {
+                return &slots[index];
+            }
+            index = (index + 1) & mask;
+        }
+        if (!insert || header->usedSlots >= header->slotCount / 4 * 3) {
+            return nullptr;
+        }
+        header->usedSlots++;
+        slots[index].day = day;
+        return &slots[index];
+    }
+
+    // A record only counts once it is live, so a worker killed half way leaves at most an unused record.
+    bool append(DaySlot& slot, const ShardRecord& record) {
+        if (header->recordCount == header->recordCapacity) {
+            return false;
+        }
+        int index = header->recordCount;
+        ShardRecord added = record;
+        added.day = slot.day;
+        added.live = 0;
+        added.nextOnDay = slot.firstRecord;
+        records[index] = added;
+        header->recordCount++;
+        slot.firstRecord = index;
+        commit();
+        records[index].live = 1;
+        return true;
+    }
+
+    // Live records that `token` has copied onto the day.
+    int copiedBy(const DaySlot& slot, uint32_t token) const {
+        int copied = 0;
+        for (int r = slot.firstRecord; r != -1; r = records[r].nextOnDay) {
+            if (records[r].live && records[r].moveToken == token) {
+                copied++;
+            }
+        }
+        return copied;
+    }
+
+    // Record the move of `from`'s bookings onto `to`, then carry it out.
+    void move(DaySlot& from, DaySlot& to) {
+        MoveIntent& intent = header->move;
+        intent.fromDay = from.day;
+        intent.toDay = to.day;
+        intent.fromHead = from.firstRecord;
+        intent.toHead = to.firstRecord;
+        intent.fromTail = -1;
+        for (int r = from.firstRecord; r != -1; r = records[r].nextOnDay) {
+            intent.fromTail = r;
+        }
+        commit();
+        intent.active = 1;
+        commit();
+        finishMove();
+    }
+
+    // Carry out the recorded move, if any. Every step stores values fixed by the intent, and the
+    // rename stops at the old tail, so running it again after a crash part way is harmless.
+    void finishMove() {
+        MoveIntent& intent = header->move;
+        if (!intent.active) {
+            return;
+        }
+        DaySlot* from = find(intent.fromDay, false);
+        DaySlot* to = find(intent.toDay, false);
+        if (from && to) {
+            if (intent.fromHead != -1) {
+                for (int r = intent.fromHead;; r = records[r].nextOnDay) {
+                    if (records[r].day == intent.fromDay) {
+                        records[r].day = intent.toDay;
+                    }
+                    if (r == intent.fromTail) {
+                        break;
+                    }
+                }
+                records[intent.fromTail].nextOnDay = intent.toHead;
+                crashCheckpoint(); // The old chain now runs into the new one
+                to->firstRecord = intent.fromHead;
+                from->firstRecord = -1;
+            }
+            to->booked = 1;
+            from->booked = 0;
+        }
+        commit();
+        intent.active = 0;
+        commit();
+    }
+
+    SegmentHeader* header;
+    DaySlot* slots;
+    ShardRecord* records;
+};
+
+// A move between shards claims the new day, copies the records, and only then drops the old day.
+// Every step but OP_BOOK and OP_MOVE can be repeated, so a step whose reply was lost is sent again.
+enum Operation {
+    OP_BOOK,    // Book record.day with `record`
+    OP_CLAIM,   // Mark `day` booked for move `token`
+    OP_MOVE,    // Move the bookings on `day` to `newDay`, both on this shard
+    OP_READ,    // Hand back up to COPY_BATCH live records on `day`, skipping the first `index`
+    OP_ATTACH,  // Add `record` as copy number `index` of move `token` on its claimed day
+    OP_RELEASE, // Undo move `token` on `day`: drop its copies and its claim
+    OP_DROP,    // Drop every record on `day` and free it, once the move has copied them
+    OP_REPORT,
+    OP_ARM      // Die at the `index`-th crash checkpoint from now; 0 disarms
+};
+
+struct Request {
+    int op;
+    int day;
+    int newDay;
+    uint32_t token;
+    int index;
+    ShardRecord record;
+};
+
+struct Totals {
+    long long registrations;
+    long long guests;
+    long long members;
+    double revenue;
+    int packageSales[PACKAGE_COUNT + 1]; // Last entry: packages not in PACKAGE_NAMES
+};
+
+struct Reply {
+    int status;
+    int count; // Records that follow
+    Totals totals;
+    ShardRecord records[COPY_BATCH];
+};
+
+const size_t REPLY_HEADER = offsetof(Reply, records);
+
+ShardedStore::Status serve(Segment& segment, const Request& request, Reply& reply) {
+    reply.count = 0;
+    switch (request.op) {
+    case OP_BOOK: {
+        DaySlot* slot = segment.find(request.record.day, true);
+        if (!slot) {
+            return ShardedStore::SHARD_FULL;
+        }
+        if (slot->booked) {
+            return ShardedStore::SHARD_TAKEN;
+        }
+        if (!segment.append(*slot, request.record)) {
+            return ShardedStore::SHARD_FULL;
+        }
+        slot->moveToken = 0;
+        slot->booked = 1;
+        return ShardedStore::SHARD_OK;
+    }
+    case OP_CLAIM: {
+        DaySlot* slot = segment.find(request.day, true);
+        if (!slot) {
+            return ShardedStore::SHARD_FULL;
+        }
+        if (slot->booked) {
+            // Already ours if the reply to an earlier attempt was lost
+            return slot->moveToken == request.token ? ShardedStore::SHARD_OK : ShardedStore::SHARD_TAKEN;
+        }
+        slot->moveToken = request.token;
+        commit();
+        slot->booked = 1;
+        return ShardedStore::SHARD_OK;
+    }
+    case OP_MOVE: {
+        DaySlot* from = segment.find(request.day, false);
+        if (!from || !from->booked) {
+            return ShardedStore::SHARD_NOT_FOUND;
+        }
+        DaySlot* to = segment.find(request.newDay, true);
+        if (!to) {
+            return ShardedStore::SHARD_FULL;
+        }
+        if (to->booked) {
+            return ShardedStore::SHARD_TAKEN;
+        }
+        segment.move(*from, *to);
+        return ShardedStore::SHARD_OK;
+    }
+    case OP_READ: {
+        const DaySlot* slot = segment.find(request.day, false);
+        if (!slot || !slot->booked) {
+            return ShardedStore::SHARD_NOT_FOUND;
+        }
+        int skipped = 0;
+        for (int r = slot->firstRecord; r != -1 && reply.count < COPY_BATCH; r = segment.records[r].nextOnDay) {
+            const ShardRecord& record = segment.records[r];
+            if (record.live && record.day == slot->day && skipped++ >= request.index) {
+                reply.records[reply.count++] = record;
+            }
+        }
+        return ShardedStore::SHARD_OK;
+    }
+    case OP_ATTACH: {
+        DaySlot* slot = segment.find(request.record.day, false);
+        if (!slot || !slot->booked || slot->moveToken != request.token) {
+            return ShardedStore::SHARD_NOT_FOUND; // Not claimed by this move
+        }
+        if (segment.copiedBy(*slot, request.token) > request.index) {
+            return ShardedStore::SHARD_OK; // Added by an attempt whose reply was lost
+        }
+        return segment.append(*slot, request.record) ? ShardedStore::SHARD_OK : ShardedStore::SHARD_FULL;
+    }
+    case OP_RELEASE: {
+        DaySlot* slot = segment.find(request.day, false);
+        if (!slot) {
+            return ShardedStore::SHARD_OK;
+        }
+        for (int r = slot->firstRecord; r != -1; r = segment.records[r].nextOnDay) {
+            if (segment.records[r].moveToken == request.token) {
+                segment.records[r].live = 0;
+            }
+        }
+        if (slot->moveToken == request.token) {
+            commit();
+            slot->booked = 0;
+            slot->moveToken = 0;
+        }
+        return ShardedStore::SHARD_OK;
+    }
+    case OP_DROP: {
+        DaySlot* slot = segment.find(request.day, false);
+        if (!slot) {
+            return ShardedStore::SHARD_OK;
+        }
+        for (int r = slot->firstRecord; r != -1; r = segment.records[r].nextOnDay) {
+            if (segment.records[r].day == slot->day) {
+                segment.records[r].live = 0;
+            }
+        }
+        commit();
+        slot->booked = 0;
+        slot->moveToken = 0;
+        return ShardedStore::SHARD_OK;
+    }
+    case OP_REPORT: {
+        Totals& totals = reply.totals;
+        memset(&totals, 0, sizeof(totals));
+        for (int r = 0; r < segment.header->recordCount; ++r) {
+            const ShardRecord& record = segment.records[r];
+            if (!record.live) {
+                continue;
+            }
+            totals.registrations++;
+            totals.guests += record.numGuests;
+            totals.members += record.isMember;
+            totals.revenue += record.packagePrice + record.advertisementPrice;
+            totals.packageSales[record.package >= 0 ? record.package : PACKAGE_COUNT]++;
+        }
+        return ShardedStore::SHARD_OK;
+    }
+    case OP_ARM:
+        crashCountdown = request.index;
+        return ShardedStore::SHARD_OK;
+    default:
+        return ShardedStore::SHARD_INVALID;
+    }
+}
+
+// Body of a worker process. Everything it touches is in the segment or on its stack.
+void runWorker(void* base, int socket) {
+    Segment segment(base);
+    Request request;
+    Reply reply;
+    while (recv(socket, &request, sizeof(request), 0) == static_cast<ssize_t>(sizeof(request))) {
+        reply.status = serve(segment, request, reply);
+        if (request.op != OP_ARM) {
+            crashCheckpoint(); // Applied, but the reply is lost
+        }
+        size_t size = REPLY_HEADER + reply.count * sizeof(ShardRecord);
+        if (send(socket, &reply, size, MSG_NOSIGNAL) != static_cast<ssize_t>(size)) {
+            break;
+        }
+    }
+    _exit(0);
+}
+
+template <size_t N>
+void copyField(char (&field)[N], const string& value) {
+    size_t length = min(value.size(), N - 1);
+    memcpy(field, value.data(), length);
+    field[length] = '\0';
+}
+
+int packageIndex(const string& packageType) {
+    for (int p = 0; p < PACKAGE_COUNT; ++p) {
+        if (packageType == PACKAGE_NAMES[p]) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+}
+
+ShardedStore::ShardedStore(int shardCount, int capacityPerShard) : restartCount(0), nextMoveToken(1), open(true) {
+    for (int s = 0; s < max(shardCount, 1); ++s) {
+        Shard shard;
+        shard.segmentBytes = Segment::bytesFor(max(capacityPerShard, 1));
+        shard.segment = mmap(nullptr, shard.segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        shard.socket = -1;
+        shard.worker = -1;
+        if (shard.segment == MAP_FAILED) {
+            open = false;
+            break;
+        }
+        Segment::format(shard.segment, max(capacityPerShard, 1));
+        shards.push_back(shard);
+        if (!spawn(s)) {
+            open = false;
+            break;
+        }
+    }
+    if (!open) {
+        stop();
+    }
+}
+
+ShardedStore::~ShardedStore() {
+    stop();
+}
+
+bool ShardedStore::spawn(int shard) {
+    int ends[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, ends) != 0) {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(ends[0]);
+        close(ends[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // Drop every router end, or the other workers would never see their socket close
+        for (size_t s = 0; s < shards.size(); ++s) {
+            if (shards[s].socket >= 0) {
+                close(shards[s].socket);
+            }
+        }
+        close(ends[0]);
+        runWorker(shards[shard].segment, ends[1]);
+    }
+    close(ends[1]);
+    shards[shard].socket = ends[0];
+    shards[shard].worker = pid;
+    return true;
+}
+
+// Reap the dead worker, finish any move it left half done, and fork a new one over the same segment.
+void ShardedStore::restart(int shard) {
+    Shard& dead = shards[shard];
+    if (dead.socket >= 0) {
+        close(dead.socket);
+        dead.socket = -1;
+    }
+    if (dead.worker > 0) {
+        kill(dead.worker, SIGKILL);
+        waitpid(dead.worker, nullptr, 0);
+        dead.worker = -1;
+    }
+    Segment(dead.segment).finishMove();
+    restartCount++;
+    spawn(shard);
+}
+
+// A worker that died between requests has lost nothing, so the request goes to its replacement.
+bool ShardedStore::sendRequest(int shard, const void* request, size_t size) {
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (shards[shard].socket >= 0 && send(shards[shard].socket, request, size, MSG_NOSIGNAL) == static_cast<ssize_t>(size)) {
+            return true;
+        }
+        restart(shard);
+    }
+    return false;
+}
+
+bool ShardedStore::receiveReply(int shard, void* reply, size_t size) {
+    ssize_t received;
+    do {
+        received = recv(shards[shard].socket, reply, size, 0);
+    } while (received < 0 && errno == EINTR);
+    if (received < static_cast<ssize_t>(REPLY_HEADER)) {
+        restart(shard);
+        return false;
+    }
+    return true;
+}
+
+// For requests that are safe to repeat: a worker that died before replying is replaced and asked again.
+bool ShardedStore::call(int shard, const void* request, size_t size, void* reply, size_t replySize) {
+    for (int attempt = 0; attempt < RETRIES; ++attempt) {
+        if (sendRequest(shard, request, size) && receiveReply(shard, reply, replySize)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ShardedStore::shardOf(const string& date) const {
+    int day, year, month;
+    if (!parseDate(date, day) || sscanf(date.c_str(), "%d-%2d", &year, &month) != 2) {
+        return -1;
+    }
+    int count = static_cast<int>(shards.size());
+    return ((year * 12 + month - 1) % count + count) % count;
+}
+
+ShardedStore::Status ShardedStore::book(const Registration& registration) {
+    int shard = shardOf(registration.eventDate);
+    Request request = Request();
+    if (shard < 0 || !parseDate(registration.eventDate, request.record.day)) {
+        return SHARD_INVALID;
+    }
+    request.op = OP_BOOK;
+    request.day = request.record.day;
+    copyField(request.record.userName, registration.userName);
+    copyField(request.record.email, registration.email);
+    copyField(request.record.packageType, registration.packageType);
+    request.record.numGuests = registration.numGuests;
+    request.record.packagePrice = registration.packagePrice;
+    request.record.advertisementPrice = registration.advertisementPrice;
+    request.record.package = static_cast<int8_t>(packageIndex(registration.packageType));
+    request.record.isMember = registration.isMember;
+
+    Reply reply;
+    if (!sendRequest(shard, &request, sizeof(request)) || !receiveReply(shard, &reply, sizeof(reply))) {
+        return SHARD_FAILED;
+    }
+    return static_cast<Status>(reply.status);
+}
+
+// Read from the segment directly: the worker only writes while the router waits for its reply.
+bool ShardedStore::isDateBooked(const string& date) const {
+    int shard = shardOf(date);
+    int day;
+    if (shard < 0 || !parseDate(date, day)) {
+        return false;
+    }
+    const DaySlot* slot = Segment(shards[shard].segment).find(day, false);
+    return slot && slot->booked;
+}
+
+ShardedStore::Status ShardedStore::reschedule(const string& oldDate, const string& newDate) {
+    int from = shardOf(oldDate);
+    int to = shardOf(newDate);
+    int oldDay, newDay;
+    if (from < 0 || to < 0 || !parseDate(oldDate, oldDay) || !parseDate(newDate, newDay)) {
+        return SHARD_INVALID;
+    }
+    // Answered from the segments; the workers check again
+    if (!isDateBooked(oldDate)) {
+        return SHARD_NOT_FOUND;
+    }
+    if (isDateBooked(newDate)) {
+        return SHARD_TAKEN;
+    }
+    Request request = Request();
+    Reply reply;
+    if (from == to) {
+        request.op = OP_MOVE;
+        request.day = oldDay;
+        request.newDay = newDay;
+        for (int attempt = 0; attempt < RETRIES; ++attempt) {
+            if (sendRequest(from, &request, sizeof(request)) && receiveReply(from, &reply, sizeof(reply))) {
+                return static_cast<Status>(reply.status);
+            }
+            // The restart finished any move the worker had started, so the dates say whether it ran
+            if (!isDateBooked(oldDate) && isDateBooked(newDate)) {
+                return SHARD_OK;
+            }
+        }
+        return SHARD_FAILED;
+    }
+
+    uint32_t token = nextMoveToken++;
+    if (nextMoveToken == 0) {
+        nextMoveToken = 1; // 0 marks a booking that was not moved in
+    }
+    request.op = OP_CLAIM;
+    request.day = newDay;
+    request.token = token;
+    if (!call(to, &request, sizeof(request), &reply, sizeof(reply))) {
+        return SHARD_FAILED;
+    }
+    if (reply.status != SHARD_OK) {
+        return static_cast<Status>(reply.status);
+    }
+
+    // Copy the old day's records across a batch at a time; the old shard keeps them meanwhile
+    Status status = SHARD_OK;
+    Request read = Request();
+    read.op = OP_READ;
+    read.day = oldDay;
+    Request attach = Request();
+    attach.op = OP_ATTACH;
+    attach.token = token;
+    int copied = 0;
+    do {
+        read.index = copied;
+        if (!call(from, &read, sizeof(read), &reply, sizeof(reply))) {
+            status = SHARD_FAILED;
+            break;
+        }
+        if (reply.status != SHARD_OK) {
+            status = static_cast<Status>(reply.status);
+            break;
+        }
+        for (int r = 0; r < reply.count && status == SHARD_OK; ++r) {
+            attach.record = reply.records[r];
+            attach.record.day = newDay;
+            attach.record.moveToken = token;
+            attach.index = copied + r;
+            Reply attached;
+            if (!call(to, &attach, sizeof(attach), &attached, sizeof(attached))) {
+                status = SHARD_FAILED;
+            }
+            else if (attached.status != SHARD_OK) {
+                status = static_cast<Status>(attached.status);
+            }
+        }
+        copied += reply.count;
+    } while (status == SHARD_OK && reply.count == COPY_BATCH);
+
+    if (status == SHARD_OK) {
+        request.op = OP_DROP;
+        request.day = oldDay;
+        if (call(from, &request, sizeof(request), &reply, sizeof(reply))) {
+            return SHARD_OK;
+        }
+        return SHARD_FAILED; // The old day may be partly dropped, so the copies have to stay
+    }
+
+    // Undo the copy; every record is still on the old day
+    request.op = OP_RELEASE;
+    request.day = newDay;
+    request.token = token;
+    call(to, &request, sizeof(request), &reply, sizeof(reply));
+    return status;
+}
+
+ShardedStore::Report ShardedStore::report() {
+    Report merged;
+    merged.registrations = 0;
+    merged.guests = 0;
+    merged.members = 0;
+    merged.revenue = 0.0;
+    merged.failedShards = 0;
+    int packageSales[PACKAGE_COUNT + 1] = { 0 };
+
+    // Every shard scans at once; the replies are merged as they are collected
+    Request request = Request();
+    request.op = OP_REPORT;
+    vector<bool> asked(shards.size(), false);
+    for (size_t s = 0; s < shards.size(); ++s) {
+        asked[s] = sendRequest(static_cast<int>(s), &request, sizeof(request));
+    }
+    for (size_t s = 0; s < shards.size(); ++s) {
+        Reply reply;
+        if (!asked[s] || !receiveReply(static_cast<int>(s), &reply, sizeof(reply))) {
+            merged.failedShards++;
+            continue;
+        }
+        merged.registrations += reply.totals.registrations;
+        merged.guests += reply.totals.guests;
+        merged.members += reply.totals.members;
+        merged.revenue += reply.totals.revenue;
+        for (int p = 0; p <= PACKAGE_COUNT; ++p) {
+            packageSales[p] += reply.totals.packageSales[p];
+        }
+    }
+    for (int p = 0; p <= PACKAGE_COUNT; ++p) {
+        if (packageSales[p] > 0) {
+            merged.packageSales[p < PACKAGE_COUNT ? PACKAGE_NAMES[p] : "Other"] = packageSales[p];
+        }
+    }
+    return merged;
+}
+
+void ShardedStore::crashShard(int shard) {
+    if (shard >= 0 && shard < shardCount() && shards[shard].worker > 0) {
+        kill(shards[shard].worker, SIGKILL);
+    }
+}
+
+void ShardedStore::crashShardAt(int shard, int checkpoints) {
+    if (shard < 0 || shard >= shardCount()) {
+        return;
+    }
+    Request request = Request();
+    request.op = OP_ARM;
+    request.index = checkpoints;
+    Reply reply;
+    if (sendRequest(shard, &request, sizeof(request))) {
+        receiveReply(shard, &reply, sizeof(reply));
+    }
+}
+
+void ShardedStore::stop() {
+    // Closing the router end makes the worker's recv return 0, and it exits
+    for (size_t s = 0; s < shards.size(); ++s) {
+        if (shards[s].socket >= 0) {
+            close(shards[s].socket);
+            shards[s].socket = -1;
+        }
+    }
+    for (size_t s = 0; s < shards.size(); ++s) {
+        if (shards[s].worker > 0) {
+            waitpid(shards[s].worker, nullptr, 0);
+            shards[s].worker = -1;
+        }
+        munmap(shards[s].segment, shards[s].segmentBytes);
+    }
+    shards.clear();
+    open = false;
+}
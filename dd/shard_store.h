@@ -0,0 +1,110 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+#include "event.h"
+
+using namespace std;
+
+// Calendar and registrations partitioned by event month over worker processes on one host.
+// Months are dealt round-robin to the shards, so consecutive months land on different workers.
+//
+// Each shard's data lives in a shared-memory segment mapped before its worker is forked. The
+// worker is the only writer; the router in the calling process sends it fixed-size requests over
+// a socket and waits for the reply. Date lookups are answered by the router straight from the
+// segment, and reports are sent to every shard at once and merged, so the scans run in parallel.
+//
+// A worker that dies is forked again on the same segment with the next request; only the request
+// in flight is lost, which the caller sees as SHARD_FAILED. Moves are the exception: they are
+// carried through a dead worker, see reschedule(). Workers never allocate, so they can be
+// restarted safely from a multithreaded process.
+//
+// POSIX only (fork and shared mmap). One thread drives the router.
+//
+// Only dd_bench and the tests drive this store so far. The dd console still books, moves and
+// reports through its in-process Event, which also keeps the waitlist, history and analytics
+// that the shards do not hold; shard_store_test checks that both give the same answers.
+class ShardedStore {
+public:
+    enum Status {
+        SHARD_OK,
+        SHARD_TAKEN,   // The date is already booked
+        SHARD_FULL,    // The owning shard has no room left
+        SHARD_INVALID,   // Not a "YYYY-MM-DD" date
+        SHARD_FAILED,    // The worker died; it has been restarted
+        SHARD_NOT_FOUND  // Nothing is booked on the date to move
+    };
+
+    // Merged over every shard that answered.
+    struct Report {
+        long long registrations;
+        long long guests;
+        long long members;
+        double revenue;
+        map<string, int> packageSales;
+        int failedShards;
+    };
+
+    // Up to capacityPerShard registrations per shard. Fork the store before starting other threads.
+    ShardedStore(int shardCount, int capacityPerShard);
+    ~ShardedStore();
+
+    bool isOpen() const {
+        return open;
+    }
+
+    int shardCount() const {
+        return static_cast<int>(shards.size());
+    }
+
+    // Shard owning the month of `date`, or -1 if it is not a valid date.
+    int shardOf(const string& date) const;
+
+    Status book(const Registration& registration);
+    bool isDateBooked(const string& date) const;
+
+    // Move the bookings on oldDate to newDate, unless oldDate is not booked or newDate is taken.
+    // Within a shard the move is recorded in the segment first, and a restart finishes it. Across
+    // shards newDate is claimed and the records copied before oldDate lets go of them; a failure
+    // part way releases the copies. Only if oldDate's shard cannot be reached to drop them are the
+    // copies kept, with SHARD_FAILED: a booking may then show twice but is never lost.
+    Status reschedule(const string& oldDate, const string& newDate);
+
+    Report report();
+
+    // Kill a worker as a crash would. For tests and benchmarks.
+    void crashShard(int shard);
+
+    // Make a worker die as a crash would at its `checkpoints`-th checkpoint from now: after it
+    // applies a request but before it replies, or half way through a move. 0 disarms. For tests.
+    void crashShardAt(int shard, int checkpoints);
+
+    long long restarts() const {
+        return restartCount;
+    }
+
+    // Stop the workers and unmap the segments.
+    void stop();
+
+private:
+    struct Shard {
+        void* segment;
+        size_t segmentBytes;
+        int socket; // Router end
+        pid_t worker;
+    };
+
+    bool spawn(int shard);
+    void restart(int shard);
+    bool sendRequest(int shard, const void* request, size_t size);
+    bool receiveReply(int shard, void* reply, size_t size);
+    bool call(int shard, const void* request, size_t size, void* reply, size_t replySize);
+
+    vector<Shard> shards;
+    long long restartCount;
+    uint32_t nextMoveToken; // Tells one move's copies from another's
+    bool open;
+};
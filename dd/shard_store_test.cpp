@@ -0,0 +1,153 @@
+// Checks that sharded moves survive a worker dying part way, refuse dates with nothing booked,
+// and leave the store agreeing with Event on the same bookings and moves.
+#include "shard_store.h"
+
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const string& what) {
+    if (!condition) {
+        cerr << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+
+Registration registration(const string& name, const string& date, int package, int guests, bool isMember) {
+    static const double PRICES[PACKAGE_COUNT] = { 250.0, 500.0, 1000.0, 2500.0 };
+    Registration booked;
+    booked.userName = name;
+    booked.email = name + "@example.com";
+    booked.eventDate = date;
+    booked.packageType = PACKAGE_NAMES[package];
+    booked.numGuests = guests;
+    booked.packagePrice = PRICES[package];
+    booked.advertisementPrice = guests % 2 == 0 ? 200.0 : 0.0;
+    booked.isMember = isMember;
+    return booked;
+}
+
+// With two shards, January and March 2024 share a shard and February is on the other.
+const char* const BOOKED[] = { "2024-01-05", "2024-01-20", "2024-02-10" };
+
+void bookAll(ShardedStore& store) {
+    for (int i = 0; i < 3; ++i) {
+        store.book(registration("guest" + to_string(i), BOOKED[i], i, 20 + i, i == 0));
+    }
+}
+
+// Kill the worker of `crashed` at every checkpoint the move passes, and check that the booking
+// ends up on exactly one of the dates with every registration still counted.
+void crashDuringMove(const string& oldDate, const string& newDate, bool crashTarget) {
+    for (int checkpoint = 1; checkpoint <= 3; ++checkpoint) {
+        ShardedStore store(2, 64);
+        bookAll(store);
+        ShardedStore::Report before = store.report();
+        int crashed = store.shardOf(crashTarget ? newDate : oldDate);
+        store.crashShardAt(crashed, checkpoint);
+        ShardedStore::Status status = store.reschedule(oldDate, newDate);
+        store.crashShardAt(crashed, 0);
+
+        string what = oldDate + " to " + newDate + ", crash at checkpoint " + to_string(checkpoint) + (crashTarget ? " of the target" : " of the source");
+        ShardedStore::Report after = store.report();
+        check(status == ShardedStore::SHARD_OK, what + ": the move completes");
+        check(!store.isDateBooked(oldDate) && store.isDateBooked(newDate), what + ": only the new date is booked");
+        check(after.failedShards == 0, what + ": every shard answers the report");
+        check(after.registrations == before.registrations, what + ": no registration is lost or doubled");
+        check(after.guests == before.guests && after.revenue == before.revenue, what + ": totals are unchanged");
+
+        // The moved booking can move again, which needs its records on the new date
+        check(store.reschedule(newDate, oldDate) == ShardedStore::SHARD_OK, what + ": the booking moves back");
+        check(store.report().registrations == before.registrations, what + ": moving back keeps every registration");
+    }
+}
+
+// A day moved away to another shard keeps its old records on its chain, unused; a move within
+// its shard onto that day has to splice onto them even if the worker dies part way.
+void crashMovingOntoFreedDay() {
+    for (int checkpoint = 1; checkpoint <= 3; ++checkpoint) {
+        ShardedStore store(2, 64);
+        bookAll(store);
+        check(store.reschedule("2024-01-05", "2024-02-20") == ShardedStore::SHARD_OK, "2024-01-05 moves to another shard");
+        int shard = store.shardOf("2024-01-20");
+        store.crashShardAt(shard, checkpoint);
+        ShardedStore::Status status = store.reschedule("2024-01-20", "2024-01-05");
+        store.crashShardAt(shard, 0);
+
+        string what = "2024-01-20 onto the freed 2024-01-05, crash at checkpoint " + to_string(checkpoint);
+        check(status == ShardedStore::SHARD_OK, what + ": the move completes");
+        check(!store.isDateBooked("2024-01-20") && store.isDateBooked("2024-01-05"), what + ": only the new date is booked");
+        check(store.reschedule("2024-01-05", "2024-03-01") == ShardedStore::SHARD_OK, what + ": the booking moves on");
+        check(store.reschedule("2024-03-01", "2024-04-01") == ShardedStore::SHARD_OK, what + ": and across shards");
+        check(store.report().registrations == 3, what + ": every registration is kept");
+    }
+}
+
+void notFound() {
+    ShardedStore store(2, 64);
+    bookAll(store);
+    check(store.reschedule("2024-03-01", "2024-03-02") == ShardedStore::SHARD_NOT_FOUND, "a free date cannot move within a shard");
+    check(store.reschedule("2024-03-01", "2024-04-02") == ShardedStore::SHARD_NOT_FOUND, "a free date cannot move across shards");
+    check(!store.isDateBooked("2024-03-02") && !store.isDateBooked("2024-04-02"), "a refused move books nothing");
+    check(store.reschedule("2024-01-05", "2024-01-20") == ShardedStore::SHARD_TAKEN, "a booked date cannot be moved onto");
+    check(store.report().registrations == 3, "refused moves keep every registration");
+}
+
+// The same bookings and moves, through Event and through the sharded store.
+void matchesEvent() {
+    Event event;
+    ShardedStore store(3, 64);
+    User staff;
+    const char* const dates[] = { "2024-01-05", "2024-02-11", "2024-03-17", "2024-04-23", "2024-05-29", "2024-06-04" };
+    for (int i = 0; i < 6; ++i) {
+        Registration booked = registration("guest" + to_string(i), dates[i], i % PACKAGE_COUNT, 15 + 7 * i, i % 3 == 0);
+        User user(booked.userName, booked.email, "", booked.packageType, booked.numGuests, booked.isMember);
+        user.eventDate = booked.eventDate;
+        bool eventBooked = event.book(user, booked.packagePrice, booked.advertisementPrice);
+        check(eventBooked == (store.book(booked) == ShardedStore::SHARD_OK), string("booking ") + dates[i] + " agrees");
+    }
+
+    // Within a shard, across shards, from a free date, onto a booked date, and back again
+    const char* const moves[][2] = {
+        { "2024-01-05", "2024-04-01" }, { "2024-02-11", "2024-02-12" }, { "2024-07-01", "2024-07-02" },
+        { "2024-03-17", "2024-05-29" }, { "2024-04-01", "2024-01-05" }, { "2024-06-04", "2024-08-08" },
+        { "2024-02-12", "2024-09-09" }, { "2024-09-09", "2024-02-11" }
+    };
+    for (size_t m = 0; m < sizeof(moves) / sizeof(moves[0]); ++m) {
+        bool eventMoved = event.rescheduleDate(staff, moves[m][0], moves[m][1]);
+        bool storeMoved = store.reschedule(moves[m][0], moves[m][1]) == ShardedStore::SHARD_OK;
+        check(eventMoved == storeMoved, string("moving ") + moves[m][0] + " to " + moves[m][1] + " agrees");
+        for (int d = 0; d < 2; ++d) {
+            check(event.isDateBooked(moves[m][d]) == store.isDateBooked(moves[m][d]), string("booked state of ") + moves[m][d] + " agrees");
+        }
+    }
+
+    Event::ReportTotals expected = event.reportTotals();
+    ShardedStore::Report report = store.report();
+    check(report.failedShards == 0, "every shard answers the report");
+    check(report.registrations == expected.registrations, "registrations agree");
+    check(report.guests == expected.guests, "guests agree");
+    check(report.members == expected.members, "members agree");
+    check(report.revenue == expected.revenue, "revenue agrees");
+    check(report.packageSales == expected.packageSales, "package sales agree");
+}
+
+}
+
+int main() {
+    crashDuringMove("2024-01-05", "2024-03-09", false); // Same shard
+    crashDuringMove("2024-01-05", "2024-02-20", false); // Across shards
+    crashDuringMove("2024-01-05", "2024-02-20", true);
+    crashMovingOntoFreedDay();
+    notFound();
+    matchesEvent();
+
+    if (failures == 0) {
+        cout << "shard_store: all checks passed" << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,246 @@
+#include "stage_timer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const char* stageName(BookingStage stage) {
+    switch (stage) {
+    case STAGE_DATE_CHECK:
+        return "Date check";
+    case STAGE_PACKAGE:
+        return "Package selection";
+    case STAGE_ADD_EVENT:
+        return "Add event/loyalty";
+    case STAGE_CONFIRMATION:
+        return "Confirmation";
+    case STAGE_ADVERTISEMENT:
+        return "Advertisement";
+    case STAGE_PAYMENT:
+        return "Payment";
+    default:
+        return "Unknown";
+    }
+}
+
+LatencyHistogram::LatencyHistogram() : total(0), maximum(0) {
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i].store(0, memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::addTo(uint64_t* merged, uint64_t& mergedTotal, uint64_t& mergedMaximum) const {
+    for (int i = 0; i < BUCKETS; ++i) {
+        merged[i] += counts[i].load(memory_order_relaxed);
+    }
+    mergedTotal += total.load(memory_order_relaxed);
+    mergedMaximum = max(mergedMaximum, maximum.load(memory_order_relaxed));
+}
+
+// Values below 16 get a bucket each; above that, the top four bits after the leading one pick
+// one of 16 sub-buckets within the value's power of two.
+int LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    int exponent = 63;
+    while ((value & (1ULL << exponent)) == 0) {
+        exponent--;
+    }
+    int bucket = (exponent - 3) * SUB_BUCKETS + static_cast<int>((value >> (exponent - 4)) & (SUB_BUCKETS - 1));
+    return bucket < BUCKETS ? bucket : BUCKETS - 1;
+}
+
+// Lowest value that falls into a bucket.
+uint64_t LatencyHistogram::bucketValue(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int exponent = bucket / SUB_BUCKETS + 3;
+    return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - 4);
+}
+
+namespace {
+
+struct StageHistograms {
+    LatencyHistogram stages[STAGE_COUNT];
+};
+
+atomic<bool> timingEnabled(true);
+
+// Every thread's histograms stay registered after the thread exits so their counts are kept.
+// The registry is never destroyed, so the periodic log can still take a last dump at exit.
+mutex& registryMutex() {
+    static mutex* instance = new mutex;
+    return *instance;
+}
+
+vector<shared_ptr<StageHistograms>>& registry() {
+    static vector<shared_ptr<StageHistograms>>* instance = new vector<shared_ptr<StageHistograms>>;
+    return *instance;
+}
+
+StageHistograms& localHistograms() {
+    thread_local shared_ptr<StageHistograms> local;
+    if (!local) {
+        local = make_shared<StageHistograms>();
+        lock_guard<mutex> lock(registryMutex());
+        registry().push_back(local);
+    }
+    return *local;
+}
+
+uint64_t percentileOf(const uint64_t* counts, uint64_t count, double q) {
+    uint64_t rank = static_cast<uint64_t>(q * (count - 1));
+    uint64_t seen = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen > rank) {
+            return LatencyHistogram::bucketValue(i);
+        }
+    }
+    return 0;
+}
+
+class PeriodicLog {
+public:
+    ~PeriodicLog() {
+        stop();
+    }
+
+    bool start(const string& logPath, int intervalSeconds) {
+        stop();
+        ofstream probe(logPath.c_str(), ios::app);
+        if (!probe) {
+            return false;
+        }
+        path = logPath;
+        interval = intervalSeconds > 0 ? intervalSeconds : 60;
+        stopping = false;
+        worker = thread(&PeriodicLog::run, this);
+        return true;
+    }
+
+    void stop() {
+        if (!worker.joinable()) {
+            return;
+        }
+        {
+            lock_guard<mutex> lock(stateMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+private:
+    void run() {
+        unique_lock<mutex> lock(stateMutex);
+        while (true) {
+            bool stopRequested = wake.wait_for(lock, chrono::seconds(interval), [this]() { return stopping; });
+            ofstream out(path.c_str(), ios::app);
+            time_t now = time(0);
+            char stamp[32];
+            strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+            out << "=== " << stamp << " ===\n";
+            dumpStageLatency(out);
+            if (stopRequested) {
+                return;
+            }
+        }
+    }
+
+    string path;
+    int interval;
+    bool stopping;
+    thread worker;
+    mutex stateMutex;
+    condition_variable wake;
+};
+
+PeriodicLog periodicLog;
+
+}
+
+void setStageTimingEnabled(bool enabled) {
+    timingEnabled.store(enabled, memory_order_relaxed);
+}
+
+bool stageTimingEnabled() {
+    return DD_STAGE_TIMING && timingEnabled.load(memory_order_relaxed);
+}
+
+void recordStageLatency(BookingStage stage, uint64_t nanoseconds) {
+    localHistograms().stages[stage].record(nanoseconds);
+}
+
+namespace {
+
+thread_local uint64_t inputWait = 0;
+
+}
+
+void addInputWait(uint64_t nanoseconds) {
+    inputWait += nanoseconds;
+}
+
+uint64_t inputWaitTotal() {
+    return inputWait;
+}
+
+void dumpStageLatency(ostream& out) {
+    vector<shared_ptr<StageHistograms>> threads;
+    {
+        lock_guard<mutex> lock(registryMutex());
+        threads = registry();
+    }
+
+    out << "-------------------------------------------------------------------------------------------------\n";
+    out << left << setw(20) << "Stage" << setw(10) << "Count" << setw(14) << "Mean (us)" << setw(14) << "p50 (us)"
+        << setw(14) << "p90 (us)" << setw(14) << "p99 (us)" << setw(14) << "Max (us)" << "\n";
+    out << "-------------------------------------------------------------------------------------------------\n";
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        vector<uint64_t> merged(LatencyHistogram::BUCKETS, 0);
+        uint64_t total = 0;
+        uint64_t maximum = 0;
+        for (size_t t = 0; t < threads.size(); ++t) {
+            threads[t]->stages[s].addTo(&merged[0], total, maximum);
+        }
+        uint64_t count = 0;
+        for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+            count += merged[i];
+        }
+
+        out << left << setw(20) << stageName(static_cast<BookingStage>(s)) << setw(10) << count << fixed << setprecision(2);
+        if (count == 0) {
+            out << "-\n";
+            continue;
+        }
+        out << setw(14) << total / 1000.0 / count
+            << setw(14) << percentileOf(&merged[0], count, 0.50) / 1000.0
+            << setw(14) << percentileOf(&merged[0], count, 0.90) / 1000.0
+            << setw(14) << percentileOf(&merged[0], count, 0.99) / 1000.0
+            << setw(14) << maximum / 1000.0 << "\n";
+    }
+    out << "-------------------------------------------------------------------------------------------------\n";
+    if (!DD_STAGE_TIMING) {
+        out << "Stage timing was compiled out of this build.\n";
+    }
+    else if (!stageTimingEnabled()) {
+        out << "Stage timing is currently disabled.\n";
+    }
+}
+
+bool startStageLatencyLog(const string& path, int intervalSeconds) {
+    return periodicLog.start(path, intervalSeconds);
+}
+
+void stopStageLatencyLog() {
+    periodicLog.stop();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+// Stage timing is compiled in unless the build sets DD_STAGE_TIMING=0, in which case the
+// DD_TIME_STAGE markers expand to nothing.
+#ifndef DD_STAGE_TIMING
+#define DD_STAGE_TIMING 1
+#endif
+
+// Steps a booking passes through, in pipeline order.
+enum BookingStage {
+    STAGE_DATE_CHECK,
+    STAGE_PACKAGE,
+    STAGE_ADD_EVENT,
+    STAGE_CONFIRMATION,
+    STAGE_ADVERTISEMENT,
+    STAGE_PAYMENT,
+    STAGE_COUNT
+};
+
+const char* stageName(BookingStage stage);
+
+// Log-linear latency histogram in the style of HdrHistogram: 16 sub-buckets per power of two,
+// so every recorded value is kept to within about 6%; the largest value is kept exactly beside
+// the buckets. Counters are relaxed atomics, written only by the owning thread and read by
+// whoever dumps the histograms.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = 61 * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    void record(uint64_t nanoseconds) {
+        atomic<uint64_t>& bucket = counts[bucketFor(nanoseconds)];
+        bucket.store(bucket.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        total.store(total.load(memory_order_relaxed) + nanoseconds, memory_order_relaxed);
+        if (nanoseconds > maximum.load(memory_order_relaxed)) {
+            maximum.store(nanoseconds, memory_order_relaxed);
+        }
+    }
+
+    void addTo(uint64_t* merged, uint64_t& mergedTotal, uint64_t& mergedMaximum) const;
+
+    static int bucketFor(uint64_t value);
+    static uint64_t bucketValue(int bucket);
+
+private:
+    atomic<uint64_t> counts[BUCKETS];
+    atomic<uint64_t> total;
+    atomic<uint64_t> maximum;
+};
+
+// Runtime switch; timers cost one relaxed load when disabled.
+void setStageTimingEnabled(bool enabled);
+bool stageTimingEnabled();
+
+void recordStageLatency(BookingStage stage, uint64_t nanoseconds);
+
+// Time this thread has spent blocked on console input. InputReader adds to it while timing is
+// enabled, and StageTimer leaves it out, so stages that prompt report only their own work.
+void addInputWait(uint64_t nanoseconds);
+uint64_t inputWaitTotal();
+
+// Merge every thread's histograms and print count, mean and percentiles per stage.
+void dumpStageLatency(ostream& out);
+
+// Append a dump to `path` every `intervalSeconds` from a background thread until stopped.
+bool startStageLatencyLog(const string& path, int intervalSeconds);
+void stopStageLatencyLog();
+
+// Times the enclosing scope into the histogram of one stage, less any wait for console input.
+class StageTimer {
+public:
+    explicit StageTimer(BookingStage stage) : stage(stage), active(stageTimingEnabled()), waitAtStart(0) {
+        if (active) {
+            waitAtStart = inputWaitTotal();
+            start = chrono::steady_clock::now();
+        }
+    }
+
+    ~StageTimer() {
+        if (active) {
+            chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+            uint64_t nanoseconds = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+            uint64_t waited = inputWaitTotal() - waitAtStart;
+            recordStageLatency(stage, nanoseconds > waited ? nanoseconds - waited : 0);
+        }
+    }
+
+private:
+    BookingStage stage;
+    bool active;
+    uint64_t waitAtStart;
+    chrono::steady_clock::time_point start;
+};
+
+#if DD_STAGE_TIMING
+#define DD_TIME_STAGE(stage) StageTimer stageTimer(stage)
+#else
+#define DD_TIME_STAGE(stage) ((void)0)
+#endif